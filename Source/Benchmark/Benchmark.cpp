@@ -0,0 +1,239 @@
+#include "Benchmark.h"
+#include "../Maths/CpuFeatures.h"
+#include "../Renderer/DrawStats.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <thread>
+
+namespace
+{
+	using namespace TV;
+	using namespace TV::Benchmark;
+
+	volatile float ResultSink = 0.f;
+
+	std::atomic<int64> NumHeapAllocations = 0;
+
+	std::string FormatNumber(double value)
+	{
+		char text[64];
+		std::snprintf(text, sizeof(text), "%.6g", value);
+		return text;
+	}
+
+	std::string GetCompilerName()
+	{
+#if defined(_MSC_VER)
+		return "msvc " + std::to_string(_MSC_FULL_VER);
+#elif defined(__clang__)
+		return std::string("clang ") + __clang_version__;
+#elif defined(__GNUC__)
+		return std::string("gcc ") + __VERSION__;
+#else
+		return "unknown";
+#endif
+	}
+
+	const char* GetSimdLevelName(Maths::SimdLevel level)
+	{
+		switch (level)
+		{
+		case Maths::SimdLevel::SSE2: return "SSE2";
+		case Maths::SimdLevel::AVX2: return "AVX2";
+		default: return "Scalar";
+		}
+	}
+
+	// per unit of work from the median time of a call, which is less affected by the odd slow repetition than the mean
+	double GetSecondsPerUnit(const BenchmarkResult& result, const WorkCount& work)
+	{
+		return work.Count > 0.0 ? result.GetMedian() / work.Count : 0.0;
+	}
+}
+
+double TV::Benchmark::BenchmarkResult::GetMinimum() const
+{
+	return SecondsPerCall.empty() ? 0.0 : *std::min_element(SecondsPerCall.begin(), SecondsPerCall.end());
+}
+
+double TV::Benchmark::BenchmarkResult::GetMedian() const
+{
+	if (SecondsPerCall.empty())
+	{
+		return 0.0;
+	}
+	std::vector<double> sorted = SecondsPerCall;
+	std::sort(sorted.begin(), sorted.end());
+	const size_t middle = sorted.size() / 2;
+	return sorted.size() % 2 != 0 ? sorted[middle] : (sorted[middle - 1] + sorted[middle]) * 0.5;
+}
+
+double TV::Benchmark::BenchmarkResult::GetMean() const
+{
+	if (SecondsPerCall.empty())
+	{
+		return 0.0;
+	}
+	double total = 0.0;
+	for (const double seconds : SecondsPerCall)
+	{
+		total += seconds;
+	}
+	return total / SecondsPerCall.size();
+}
+
+double TV::Benchmark::BenchmarkResult::GetStandardDeviation() const
+{
+	if (SecondsPerCall.size() < 2)
+	{
+		return 0.0;
+	}
+	const double mean = GetMean();
+	double totalSquares = 0.0;
+	for (const double seconds : SecondsPerCall)
+	{
+		totalSquares += (seconds - mean) * (seconds - mean);
+	}
+	return std::sqrt(totalSquares / (SecondsPerCall.size() - 1));
+}
+
+bool TV::Benchmark::BenchmarkRunner::ShouldRun(const std::string& name) const
+{
+	return Options.Filter.empty() || name.find(Options.Filter) != std::string::npos;
+}
+
+void TV::Benchmark::BenchmarkRunner::AddResult(const BenchmarkResult& result)
+{
+	const double median = result.GetMedian();
+	const double spread = median > 0.0 ? 100.0 * result.GetStandardDeviation() / median : 0.0;
+	std::printf("%-48s %12.1f us/call +-%4.1f%% %8.2f allocs/call", result.Name.c_str(), median * 1e6, spread, result.HeapAllocationsPerCall);
+	for (const WorkCount& work : result.Work)
+	{
+		const double secondsPerUnit = GetSecondsPerUnit(result, work);
+		if (work.Unit == "byte")
+		{
+			std::printf("  %10.1f MB/s", secondsPerUnit > 0.0 ? 1e-6 / secondsPerUnit : 0.0);
+		}
+		else
+		{
+			std::printf("  %10.3f ns/%s  %12.4g %ss/s", secondsPerUnit * 1e9, work.Unit.c_str(), secondsPerUnit > 0.0 ? 1.0 / secondsPerUnit : 0.0, work.Unit.c_str());
+		}
+	}
+	std::printf("\n");
+	std::fflush(stdout);
+
+	Results.push_back(result);
+}
+
+std::string TV::Benchmark::BenchmarkRunner::GetJson() const
+{
+	std::string json = "{\n";
+	json += "  \"build\": { \"compiler\": \"" + GetCompilerName() + "\"";
+#if defined(NDEBUG)
+	json += ", \"optimized\": true";
+#else
+	json += ", \"optimized\": false";
+#endif
+	json += std::string(", \"drawProfiling\": ") + (TV_DRAW_PROFILING ? "true" : "false") + " },\n";
+	json += "  \"machine\": { \"hardwareThreads\": " + std::to_string(std::thread::hardware_concurrency());
+	json += std::string(", \"simdLevel\": \"") + GetSimdLevelName(Maths::CpuFeatures::Get().GetSimdLevel()) + "\" },\n";
+	json += "  \"options\": { \"repetitions\": " + std::to_string(Options.Repetitions) + ", \"minRepetitionTime\": " + FormatNumber(Options.MinRepetitionTime) + " },\n";
+	json += "  \"benchmarks\": [";
+
+	for (size_t resultIndex = 0; resultIndex != Results.size(); ++resultIndex)
+	{
+		const BenchmarkResult& result = Results[resultIndex];
+		json += resultIndex == 0 ? "\n" : ",\n";
+		json += "    { \"name\": \"" + result.Name + "\", \"callsPerRepetition\": " + std::to_string(result.CallsPerRepetition);
+		json += ", \"secondsPerCall\": { \"min\": " + FormatNumber(result.GetMinimum()) + ", \"median\": " + FormatNumber(result.GetMedian());
+		json += ", \"mean\": " + FormatNumber(result.GetMean()) + ", \"stddev\": " + FormatNumber(result.GetStandardDeviation()) + ", \"samples\": [";
+		for (size_t sample = 0; sample != result.SecondsPerCall.size(); ++sample)
+		{
+			json += (sample == 0 ? "" : ", ") + FormatNumber(result.SecondsPerCall[sample]);
+		}
+		json += "] }, \"heapAllocationsPerCall\": " + FormatNumber(result.HeapAllocationsPerCall) + ", \"work\": [";
+		for (size_t workIndex = 0; workIndex != result.Work.size(); ++workIndex)
+		{
+			const WorkCount& work = result.Work[workIndex];
+			const double secondsPerUnit = GetSecondsPerUnit(result, work);
+			json += workIndex == 0 ? " " : ", ";
+			json += "{ \"unit\": \"" + work.Unit + "\", \"perCall\": " + FormatNumber(work.Count);
+			json += ", \"nsPerUnit\": " + FormatNumber(secondsPerUnit * 1e9) + ", \"perSecond\": " + FormatNumber(secondsPerUnit > 0.0 ? 1.0 / secondsPerUnit : 0.0);
+			if (work.Unit == "byte")
+			{
+				json += ", \"MBPerSecond\": " + FormatNumber(secondsPerUnit > 0.0 ? 1e-6 / secondsPerUnit : 0.0);
+			}
+			json += " }";
+		}
+		json += " ] }";
+	}
+	json += "\n  ]\n}\n";
+	return json;
+}
+
+void TV::Benchmark::KeepResult(float value)
+{
+	ResultSink = ResultSink + value;
+}
+
+TV::int64 TV::Benchmark::GetNumHeapAllocations()
+{
+	return NumHeapAllocations.load(std::memory_order_relaxed);
+}
+
+// The array and nothrow forms all end up in these
+void* operator new(std::size_t size)
+{
+	NumHeapAllocations.fetch_add(1, std::memory_order_relaxed);
+	if (void* const memory = std::malloc(size != 0 ? size : 1))
+	{
+		return memory;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept
+{
+	std::free(memory);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+	NumHeapAllocations.fetch_add(1, std::memory_order_relaxed);
+	const std::size_t alignmentBytes = (std::size_t)alignment;
+	size = (std::max<std::size_t>(size, 1) + alignmentBytes - 1) & ~(alignmentBytes - 1);
+#if defined(_MSC_VER)
+	void* const memory = _aligned_malloc(size, alignmentBytes);
+#else
+	void* const memory = std::aligned_alloc(alignmentBytes, size);
+#endif
+	if (memory == nullptr)
+	{
+		throw std::bad_alloc();
+	}
+	return memory;
+}
+
+void operator delete(void* memory, std::align_val_t) noexcept
+{
+#if defined(_MSC_VER)
+	_aligned_free(memory);
+#else
+	std::free(memory);
+#endif
+}
+
+void operator delete(void* memory, std::size_t, std::align_val_t alignment) noexcept
+{
+	operator delete(memory, alignment);
+}
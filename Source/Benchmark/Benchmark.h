@@ -0,0 +1,123 @@
+#pragma once
+
+#include "../Maths/Types.h"
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace TV
+{
+	namespace Benchmark
+	{
+		// an amount of work done by each call of a benchmark, e.g. 4096 pixels, reported as time per unit and units per second
+		struct WorkCount
+		{
+			std::string Unit; // singular, "byte" is also reported in MB/s
+			double Count = 0.0;
+		};
+
+		struct BenchmarkResult
+		{
+			std::string Name;
+			int64 CallsPerRepetition = 0;
+			std::vector<double> SecondsPerCall; // one per repetition
+			double HeapAllocationsPerCall = 0.0; // averaged over every timed call
+
+			std::vector<WorkCount> Work;
+
+			double GetMinimum() const;
+			double GetMedian() const;
+			double GetMean() const;
+			double GetStandardDeviation() const;
+		};
+
+		// operator new is replaced in the benchmark to count every allocation, from any thread, since the program started
+		int64 GetNumHeapAllocations();
+
+		struct BenchmarkOptions
+		{
+			std::string Filter; // only benchmarks with this in their name are run, empty for all
+			int32 Repetitions = 10;
+			double MinRepetitionTime = 0.1; // seconds, calls are repeated within a repetition until it takes at least this long
+		};
+
+		// Times benchmarks with repetition, keeping the results for printing and writing as JSON.
+		// Each repetition is timed separately so noise shows up in the spread rather than being averaged away
+		class BenchmarkRunner
+		{
+		public:
+			explicit BenchmarkRunner(const BenchmarkOptions& options) : Options(options) {}
+
+			bool ShouldRun(const std::string& name) const;
+
+			// Times body(), which does work of each kind in work per call. Calls once to warm caches before timing,
+			// then finds how many calls fill MinRepetitionTime. Does nothing if the filter excludes it
+			template<class TBody>
+			void Run(const std::string& name, const std::vector<WorkCount>& work, TBody&& body)
+			{
+				if (!ShouldRun(name))
+				{
+					return;
+				}
+
+				body();
+
+				int64 numCalls = 1;
+				while (true)
+				{
+					const double seconds = TimeCalls(numCalls, body);
+					if (seconds >= Options.MinRepetitionTime || numCalls >= MaxCallsPerRepetition)
+					{
+						break;
+					}
+					// aim a little over, so the next attempt is usually the last
+					const double scale = seconds > 0.0 ? Options.MinRepetitionTime * 1.2 / seconds : 10.0;
+					numCalls = (int64)(numCalls * (scale < 2.0 ? 2.0 : scale > 10.0 ? 10.0 : scale));
+				}
+
+				BenchmarkResult result;
+				result.Name = name;
+				result.Work = work;
+				result.CallsPerRepetition = numCalls;
+				result.SecondsPerCall.reserve(Options.Repetitions);
+				const int64 startAllocations = GetNumHeapAllocations();
+				for (int32 repetition = 0; repetition != Options.Repetitions; ++repetition)
+				{
+					result.SecondsPerCall.push_back(TimeCalls(numCalls, body) / numCalls);
+				}
+				result.HeapAllocationsPerCall = (GetNumHeapAllocations() - startAllocations) / ((double)numCalls * Options.Repetitions);
+				AddResult(result);
+			}
+
+			const std::vector<BenchmarkResult>& GetResults() const { return Results; }
+
+			// the results with some details of the build and machine, for comparing runs
+			std::string GetJson() const;
+
+		private:
+			static constexpr int64 MaxCallsPerRepetition = 1ll << 30;
+
+			template<class TBody>
+			static double TimeCalls(int64 numCalls, TBody& body)
+			{
+				const auto startTime = std::chrono::steady_clock::now();
+				for (int64 call = 0; call != numCalls; ++call)
+				{
+					body();
+				}
+				return std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+			}
+
+			// stores the result and prints a line for it
+			void AddResult(const BenchmarkResult& result);
+
+			BenchmarkOptions Options;
+			std::vector<BenchmarkResult> Results;
+		};
+
+		// stops the compiler optimising away work whose result is otherwise unused
+		void KeepResult(float value);
+
+	}
+}
@@ -0,0 +1,394 @@
+#include "Benchmark.h"
+#include "../Image/TgaFiles.h"
+#include "../Image/TgaImage.h"
+#include "../Maths/Geometry.h"
+#include "../Model/Model.h"
+#include "../Renderer/Drawing.h"
+#include "../Renderer/RenderTargetPool.h"
+#include "../Renderer/ThreadPool.h"
+#include "../Shaders/DefaultScene.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <random>
+
+using namespace TV;
+using namespace TV::Benchmark;
+using namespace TV::Maths;
+using namespace TV::Renderer;
+
+namespace
+{
+	// everything is generated from a fixed seed, so every run times the same work
+	constexpr uint32 RandomSeed = 12345;
+
+	const Vec2i CanvasSize(1024, 1024);
+
+	struct FlatTriangle
+	{
+		Vec2i Points[3];
+	};
+
+	// triangles with corners anywhere in a square of the given size, at random places on the canvas
+	std::vector<FlatTriangle> MakeTriangles(int32 size, int32 count, double& outTotalArea)
+	{
+		std::mt19937 random(RandomSeed);
+		std::uniform_int_distribution<int32> cornerX(0, CanvasSize.X - size - 1);
+		std::uniform_int_distribution<int32> cornerY(0, CanvasSize.Y - size - 1);
+		std::uniform_int_distribution<int32> offset(0, size);
+
+		std::vector<FlatTriangle> triangles(count);
+		outTotalArea = 0.0;
+		for (FlatTriangle& triangle : triangles)
+		{
+			const Vec2i corner(cornerX(random), cornerY(random));
+			for (Vec2i& point : triangle.Points)
+			{
+				point = corner + Vec2i(offset(random), offset(random));
+			}
+			const Vec2i edgeA = triangle.Points[1] - triangle.Points[0];
+			const Vec2i edgeB = triangle.Points[2] - triangle.Points[0];
+			outTotalArea += std::abs((double)edgeA.X * edgeB.Y - (double)edgeA.Y * edgeB.X) * 0.5;
+		}
+		return triangles;
+	}
+
+	// enough triangles that small ones aren't dominated by call overhead, and few enough that large ones don't take too long
+	int32 GetNumTriangles(int32 size)
+	{
+		return GetMax(16, 262144 / (size * size));
+	}
+
+	constexpr int32 TriangleSizes[] = { 4, 16, 64, 256 };
+
+	void BenchmarkGeometry(BenchmarkRunner& runner)
+	{
+		constexpr int32 numPoints = 4096;
+		const Vec2f a(10.f, 10.f), b(500.f, 40.f), c(200.f, 400.f);
+
+		std::mt19937 random(RandomSeed);
+		std::uniform_real_distribution<float> coordinate(0.f, 512.f);
+		std::vector<Vec2f> points(numPoints);
+		for (Vec2f& point : points)
+		{
+			point = Vec2f(coordinate(random), coordinate(random));
+		}
+
+		runner.Run("Geometry/ComputeBarycentricCoordinate", { { "point", numPoints } }, [&]()
+			{
+				float total = 0.f;
+				for (const Vec2f& point : points)
+				{
+					total += ComputeBarycentricCoordinate(point, a, b, c).X;
+				}
+				KeepResult(total);
+			});
+	}
+
+	void BenchmarkDrawing(BenchmarkRunner& runner)
+	{
+		MemoryCanvas canvas(CanvasSize);
+		const Colour colour(255, 255, 255);
+
+		for (const int32 length : { 4, 32, 256 })
+		{
+			constexpr int32 numLines = 1024;
+			std::mt19937 random(RandomSeed);
+			std::uniform_int_distribution<int32> startCoordinate(length, CanvasSize.X - length - 1);
+			std::uniform_int_distribution<int32> minorOffset(-length, length);
+			std::uniform_int_distribution<int32> choice(0, 3);
+
+			// lines of the given length along their major axis, in every direction
+			std::vector<std::pair<Vec2i, Vec2i>> lines(numLines);
+			for (auto& [start, end] : lines)
+			{
+				start = Vec2i(startCoordinate(random), startCoordinate(random));
+				const int32 direction = choice(random);
+				const int32 major = direction & 1 ? length : -length;
+				end = start + (direction & 2 ? Vec2i(major, minorOffset(random)) : Vec2i(minorOffset(random), major));
+			}
+
+			// the end pixel isn't drawn
+			runner.Run("Drawing/DrawLine/length" + std::to_string(length), { { "pixel", (double)numLines * length }, { "line", numLines } }, [&]()
+				{
+					for (const auto& [start, end] : lines)
+					{
+						DrawLine(start, end, canvas, colour);
+					}
+				});
+		}
+
+		for (const int32 size : TriangleSizes)
+		{
+			double totalArea = 0.0;
+			const std::vector<FlatTriangle> triangles = MakeTriangles(size, GetNumTriangles(size), totalArea);
+			const std::vector<WorkCount> work = { { "pixel", totalArea }, { "triangle", (double)triangles.size() } };
+
+			runner.Run("Drawing/DrawTriangle_LineFill/size" + std::to_string(size), work, [&]()
+				{
+					for (const FlatTriangle& triangle : triangles)
+					{
+						DrawTriangle_LineFill(triangle.Points[0], triangle.Points[1], triangle.Points[2], canvas, colour);
+					}
+				});
+			runner.Run("Drawing/DrawTriangle_Barycentric/size" + std::to_string(size), work, [&]()
+				{
+					for (const FlatTriangle& triangle : triangles)
+					{
+						DrawTriangle_Barycentric(triangle.Points[0], triangle.Points[1], triangle.Points[2], canvas, colour);
+					}
+				});
+		}
+	}
+
+	void BenchmarkDepthBuffer(BenchmarkRunner& runner)
+	{
+		for (const Vec2i size : { Vec2i(1920, 1080), Vec2i(3840, 2160) })
+		{
+			DepthBuffer depthBuffer(size);
+			runner.Run("DepthBuffer/ClearBuffer/" + std::to_string(size.X) + "x" + std::to_string(size.Y), { { "pixel", (double)size.X * size.Y } }, [&]()
+				{
+					depthBuffer.ClearBuffer();
+				});
+		}
+	}
+
+	void BenchmarkRasterizer(BenchmarkRunner& runner, const Model* model, const Texture* diffuse, Renderer::ThreadPool* threadPool)
+	{
+		for (const int32 size : TriangleSizes)
+		{
+			double totalArea = 0.0;
+			const std::vector<FlatTriangle> triangles = MakeTriangles(size, GetNumTriangles(size), totalArea);
+
+			// all at the same depth, so every pixel passes the depth test every time
+			std::mt19937 random(RandomSeed);
+			std::uniform_real_distribution<float> texCoord(0.f, 1.f);
+			using VertexOutput = Shaders::Rasterizer_SimpleLitDiffuse::VertexOutput;
+			std::vector<VertexOutput> vertices;
+			vertices.reserve(triangles.size() * 3);
+			for (const FlatTriangle& triangle : triangles)
+			{
+				for (const Vec2i& point : triangle.Points)
+				{
+					VertexOutput& vertex = vertices.emplace_back();
+					vertex.Position = Vec4f(point.X * 2.f / CanvasSize.X - 1.f, point.Y * 2.f / CanvasSize.Y - 1.f, 0.5f);
+					vertex.Normal = Vec3f(0.f, 0.f, 1.f);
+					vertex.TexCoord = Vec2f(texCoord(random), texCoord(random));
+				}
+			}
+
+			RenderTarget target(CanvasSize);
+			target.Clear(Colour());
+			Shaders::Rasterizer_SimpleLitDiffuse rasterizer;
+			Shaders::DefaultScene::Setup(rasterizer, 1.f, diffuse);
+			rasterizer.Pipeline.Culling = CullMode::None;
+			const RenderContext context = target.GetRenderContext();
+
+			runner.Run("Rasterizer/DrawTriangle/size" + std::to_string(size), { { "pixel", totalArea }, { "triangle", (double)triangles.size() } }, [&]()
+				{
+					for (size_t index = 0; index != vertices.size(); index += 3)
+					{
+						rasterizer.DrawTriangle(context, vertices[index], vertices[index + 1], vertices[index + 2]);
+					}
+				});
+		}
+
+		if (model == nullptr)
+		{
+			return;
+		}
+
+		for (const Vec2i size : { Vec2i(600, 800), Vec2i(1024, 1024), Vec2i(2048, 2048) })
+		{
+			RenderTarget target(size);
+			Shaders::Rasterizer_SimpleLitDiffuse rasterizer;
+			Shaders::DefaultScene::Setup(rasterizer, size.X / (float)size.Y, diffuse);
+			const RenderContext context = target.GetRenderContext(threadPool);
+
+			// clearing is part of drawing a frame, and without it every triangle after the first frame fails the depth test
+			const std::string name = "Rasterizer/DrawModel/african_head/" + std::to_string(size.X) + "x" + std::to_string(size.Y);
+			runner.Run(name, { { "pixel", (double)size.X * size.Y }, { "triangle", (double)model->NumTris() } }, [&]()
+				{
+					target.Clear(Colour());
+					rasterizer.DrawModel(*model, context);
+				});
+		}
+	}
+
+	void BenchmarkLoading(BenchmarkRunner& runner, const std::string& modelFile)
+	{
+		const std::error_code noError;
+		std::error_code error;
+		const double fileSize = (double)std::filesystem::file_size(modelFile, error);
+		if (error != noError)
+		{
+			return;
+		}
+
+		Model counted;
+		if (!counted.LoadWavefrontFile(modelFile.c_str()))
+		{
+			return;
+		}
+		runner.Run("Model/LoadWavefrontFile/african_head", { { "byte", fileSize }, { "triangle", (double)counted.NumTris() } }, [&]()
+			{
+				Model model;
+				model.LoadWavefrontFile(modelFile.c_str());
+				KeepResult((float)model.NumTris());
+			});
+	}
+
+	void BenchmarkImages(BenchmarkRunner& runner, const Model* model, const Texture* diffuse)
+	{
+		// a render rather than noise, so run length encoding has the kind of runs it would see in practice
+		TGAImage image(CanvasSize.X, CanvasSize.Y, TGAImage::RGB);
+		if (model != nullptr)
+		{
+			DepthBuffer depthBuffer(CanvasSize);
+			RenderContext context;
+			context.Canvas = &image;
+			context.DepthBuffer = &depthBuffer;
+			Shaders::Rasterizer_SimpleLitDiffuse rasterizer;
+			Shaders::DefaultScene::Setup(rasterizer, 1.f, diffuse);
+			rasterizer.DrawModel(*model, context);
+		}
+
+		const double imageBytes = (double)CanvasSize.X * CanvasSize.Y * 3;
+		const std::filesystem::path directory = std::filesystem::temp_directory_path();
+		const std::string rawFile = (directory / "tinyrenderer_benchmark_raw.tga").string();
+		const std::string rleFile = (directory / "tinyrenderer_benchmark_rle.tga").string();
+
+		runner.Run("Image/WriteTga/raw", { { "byte", imageBytes } }, [&]() { image.write_tga_file(rawFile.c_str(), false); });
+		runner.Run("Image/WriteTga/rle", { { "byte", imageBytes } }, [&]() { image.write_tga_file(rleFile.c_str(), true); });
+
+		for (const auto& [name, file] : { std::make_pair("raw", rawFile), std::make_pair("rle", rleFile) })
+		{
+			if (!std::filesystem::exists(file))
+			{
+				continue;
+			}
+			runner.Run(std::string("Image/ReadTga/") + name, { { "byte", imageBytes } }, [&]()
+				{
+					TGAImage loaded;
+					loaded.read_tga_file(file.c_str());
+					KeepResult((float)loaded.get_width());
+				});
+		}
+
+		std::error_code ignored;
+		std::filesystem::remove(rawFile, ignored);
+		std::filesystem::remove(rleFile, ignored);
+	}
+
+	void PrintUsage(const char* programName)
+	{
+		std::printf("usage: %s [options]\n\n", programName);
+		std::printf("Times parts of the renderer, printing a line for each and optionally writing all results as JSON.\n\n");
+		std::printf("  --filter <text>           only run benchmarks whose name contains text\n");
+		std::printf("  --repetitions <n>         times each benchmark is measured, default 10\n");
+		std::printf("  --min-time <seconds>      shortest time each repetition runs for, default 0.1\n");
+		std::printf("  --threads <n>             threads to draw models with, default 1 (no worker threads), 0 = one per core\n");
+		std::printf("  --content <directory>     where african_head.obj and its texture are, default Content\n");
+		std::printf("  --json <file>             write the results to file as JSON\n");
+		std::printf("  --help                    show this message\n");
+	}
+}
+
+int main(int argc, char** argv)
+{
+	BenchmarkOptions options;
+	int32 numThreads = 1;
+	std::string contentDirectory = "Content";
+	std::string jsonFile;
+
+	for (int32 index = 1; index < argc; ++index)
+	{
+		const std::string argument = argv[index];
+		if (argument == "--help" || argument == "-h")
+		{
+			PrintUsage(argv[0]);
+			return 0;
+		}
+		if (index + 1 == argc)
+		{
+			std::fprintf(stderr, "unknown option or missing value: %s\n", argument.c_str());
+			return 1;
+		}
+		const std::string value = argv[++index];
+		if (argument == "--filter")
+		{
+			options.Filter = value;
+		}
+		else if (argument == "--repetitions")
+		{
+			options.Repetitions = GetMax(1, std::atoi(value.c_str()));
+		}
+		else if (argument == "--min-time")
+		{
+			options.MinRepetitionTime = std::atof(value.c_str());
+		}
+		else if (argument == "--threads")
+		{
+			numThreads = std::atoi(value.c_str());
+		}
+		else if (argument == "--content")
+		{
+			contentDirectory = value;
+		}
+		else if (argument == "--json")
+		{
+			jsonFile = value;
+		}
+		else
+		{
+			std::fprintf(stderr, "unknown option %s\n", argument.c_str());
+			return 1;
+		}
+	}
+
+	std::unique_ptr<Renderer::ThreadPool> threadPool;
+	if (numThreads != 1)
+	{
+		threadPool = std::make_unique<Renderer::ThreadPool>(numThreads);
+	}
+
+	const std::string modelFile = contentDirectory + "/african_head.obj";
+	const std::string diffuseFile = contentDirectory + "/african_head_diffuse.tga";
+
+	Model model;
+	const bool bModelLoaded = model.LoadWavefrontFile(modelFile.c_str());
+	if (!bModelLoaded)
+	{
+		std::fprintf(stderr, "can't load %s, skipping benchmarks which need it\n", modelFile.c_str());
+	}
+
+	Texture diffuse;
+	const bool bDiffuseLoaded = LoadTexture(diffuseFile.c_str(), diffuse);
+	if (!bDiffuseLoaded)
+	{
+		std::fprintf(stderr, "can't load %s, drawing untextured\n", diffuseFile.c_str());
+	}
+
+	BenchmarkRunner runner(options);
+	BenchmarkGeometry(runner);
+	BenchmarkDrawing(runner);
+	BenchmarkDepthBuffer(runner);
+	BenchmarkRasterizer(runner, bModelLoaded ? &model : nullptr, bDiffuseLoaded ? &diffuse : nullptr, threadPool.get());
+	BenchmarkLoading(runner, modelFile);
+	BenchmarkImages(runner, bModelLoaded ? &model : nullptr, bDiffuseLoaded ? &diffuse : nullptr);
+
+	if (!jsonFile.empty())
+	{
+		std::ofstream file(jsonFile);
+		file << runner.GetJson();
+		if (!file.good())
+		{
+			std::fprintf(stderr, "can't write %s\n", jsonFile.c_str());
+			return 1;
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,108 @@
+#include "RenderJob.h"
+#include "../Renderer/ThreadPool.h"
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+
+using namespace TV;
+using namespace Headless;
+
+namespace
+{
+	void PrintUsage(const char* programName)
+	{
+		std::printf("usage: %s [--jobs <file>] [--threads <n>] [render options]\n\n", programName);
+		std::printf("Renders a model to an image without a window. With --jobs, every line of the file is a render\n");
+		std::printf("whose options are applied on top of those given on the command line.\n\n");
+		std::printf("  --jobs <file>                 job file, one set of render options per line\n");
+		std::printf("  --threads <n>                 threads to render with, 0 = one per core, 1 = no worker threads\n");
+		std::printf("  --help                        show this message\n\n");
+		std::printf("render options:\n%s", GetRenderJobUsage());
+	}
+}
+
+int main(int argc, char** argv)
+{
+	std::string jobFile;
+	int32 numThreads = 0;
+	std::vector<std::string> renderArguments;
+
+	for (int32 index = 1; index < argc; ++index)
+	{
+		const std::string argument = argv[index];
+		if (argument == "--help" || argument == "-h")
+		{
+			PrintUsage(argv[0]);
+			return 0;
+		}
+		if ((argument == "--jobs" || argument == "--threads") && index + 1 == argc)
+		{
+			std::fprintf(stderr, "missing value for %s\n", argument.c_str());
+			return 1;
+		}
+		if (argument == "--jobs")
+		{
+			jobFile = argv[++index];
+		}
+		else if (argument == "--threads")
+		{
+			numThreads = std::atoi(argv[++index]);
+		}
+		else
+		{
+			renderArguments.push_back(argument);
+		}
+	}
+
+	std::string error;
+	RenderJob defaults;
+	if (!ParseRenderJobOptions(renderArguments, defaults, error))
+	{
+		std::fprintf(stderr, "%s\n\n", error.c_str());
+		PrintUsage(argv[0]);
+		return 1;
+	}
+
+	std::vector<RenderJob> parsedJobs;
+	if (jobFile.empty())
+	{
+		parsedJobs.push_back(defaults);
+	}
+	else if (!ParseRenderJobFile(jobFile.c_str(), defaults, parsedJobs, error))
+	{
+		std::fprintf(stderr, "%s\n", error.c_str());
+		return 1;
+	}
+
+	std::vector<RenderJob> jobs;
+	for (const RenderJob& job : parsedJobs)
+	{
+		ExpandTurntable(job, jobs);
+	}
+
+	// a single thread renders inline, without the binning the pool brings
+	std::unique_ptr<Renderer::ThreadPool> threadPool;
+	if (numThreads != 1)
+	{
+		threadPool = std::make_unique<Renderer::ThreadPool>(numThreads);
+	}
+
+	RenderJobRunner runner(threadPool.get());
+	std::vector<std::string> errors;
+	const auto startTime = std::chrono::steady_clock::now();
+	const int32 numFailed = runner.Run(jobs, errors);
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+	for (const std::string& message : errors)
+	{
+		std::fprintf(stderr, "%s\n", message.c_str());
+	}
+	if (jobs.size() > 1)
+	{
+		// includes loading, so a single batch of many views is the fairest measure of throughput
+		const int32 numRendered = (int32)jobs.size() - numFailed;
+		std::printf("rendered %d of %d jobs in %.2fs, %.1f images/s\n", numRendered, (int32)jobs.size(), seconds, numRendered / seconds);
+	}
+	return numFailed == 0 ? 0 : 1;
+}
@@ -0,0 +1,610 @@
+#include "RenderJob.h"
+#include "../Image/TgaFiles.h"
+#include "../Image/TgaImage.h"
+#include "../Renderer/DepthBuffer.h"
+#include "../Renderer/ViewBatch.h"
+#include "../Shaders/Shader_SimpleLitDiffuse.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <numbers>
+
+namespace
+{
+	using namespace TV;
+	using namespace TV::Maths;
+	using namespace TV::Renderer;
+	using namespace TV::Headless;
+
+	bool ParseFloat(const std::string& text, float& outValue)
+	{
+		char* end = nullptr;
+		outValue = std::strtof(text.c_str(), &end);
+		return !text.empty() && *end == '\0';
+	}
+
+	bool ParseInt(const std::string& text, int32& outValue)
+	{
+		char* end = nullptr;
+		outValue = (int32)std::strtol(text.c_str(), &end, 10);
+		return !text.empty() && *end == '\0';
+	}
+
+	// "x,y,z"
+	bool ParseVec3(const std::string& text, Vec3f& outValue)
+	{
+		const size_t first = text.find(',');
+		const size_t second = first != std::string::npos ? text.find(',', first + 1) : std::string::npos;
+		if (second == std::string::npos)
+		{
+			return false;
+		}
+		return ParseFloat(text.substr(0, first), outValue.X) && ParseFloat(text.substr(first + 1, second - first - 1), outValue.Y) && ParseFloat(text.substr(second + 1), outValue.Z);
+	}
+
+	// "WxH"
+	bool ParseSize(const std::string& text, Vec2i& outValue)
+	{
+		const size_t separator = text.find('x');
+		if (separator == std::string::npos)
+		{
+			return false;
+		}
+		return ParseInt(text.substr(0, separator), outValue.X) && ParseInt(text.substr(separator + 1), outValue.Y) && outValue.X > 0 && outValue.Y > 0;
+	}
+
+	bool ParseCullMode(const std::string& text, CullMode& outValue)
+	{
+		if (text == "none")
+		{
+			outValue = CullMode::None;
+		}
+		else if (text == "back")
+		{
+			outValue = CullMode::Back;
+		}
+		else if (text == "front")
+		{
+			outValue = CullMode::Front;
+		}
+		else
+		{
+			return false;
+		}
+		return true;
+	}
+
+	bool ParseTextureFilter(const std::string& text, TextureFilter& outValue)
+	{
+		if (text == "point")
+		{
+			outValue = TextureFilter::Point;
+		}
+		else if (text == "bilinear")
+		{
+			outValue = TextureFilter::Bilinear;
+		}
+		else if (text == "trilinear")
+		{
+			outValue = TextureFilter::Trilinear;
+		}
+		else
+		{
+			return false;
+		}
+		return true;
+	}
+
+	// written the same way up as the colour image, see WriteCanvasTga
+	bool WriteDepthImage(const RenderTarget& target, const std::string& fileName)
+	{
+		const Vec2i size = target.GetSize();
+		TGAImage image(size.X, size.Y, TGAImage::GRAYSCALE);
+		for (int32 y = 0; y != size.Y; ++y)
+		{
+			const DepthBuffer::BufferType* source = target.Depth.GetRow(y);
+			uint8* destination = image.GetRowData(size.Y - 1 - y);
+			for (int32 x = 0; x != size.X; ++x)
+			{
+				destination[x] = (uint8)(255.f * GetClamped(source[x], 0.f, 1.f));
+			}
+		}
+		return image.write_tga_file(fileName.c_str());
+	}
+
+	bool WriteStats(const DrawStats& stats, const std::string& fileName)
+	{
+		std::ofstream file(fileName);
+		file << stats.ToJson() << "\n";
+		return file.good();
+	}
+
+	bool WriteOutputFiles(const RenderJob& job, const RenderTarget& target, bool bHasDepth, const DrawStats& stats, std::string& outError)
+	{
+		if (!WriteCanvasTga(target.Canvas, job.OutputFile.c_str()))
+		{
+			outError = "can't write " + job.OutputFile;
+			return false;
+		}
+		if (bHasDepth && !job.DepthOutputFile.empty() && !WriteDepthImage(target, job.DepthOutputFile))
+		{
+			outError = "can't write " + job.DepthOutputFile;
+			return false;
+		}
+		if (!job.StatsOutputFile.empty() && !WriteStats(stats, job.StatsOutputFile))
+		{
+			outError = "can't write " + job.StatsOutputFile;
+			return false;
+		}
+		return true;
+	}
+
+	// replaces the first run of # with the zero padded view index, or adds the index before the extension if there isn't one
+	std::string GetViewFileName(const std::string& fileName, int32 viewIndex)
+	{
+		std::string number = std::to_string(viewIndex);
+		const size_t first = fileName.find('#');
+		if (first == std::string::npos)
+		{
+			const size_t extension = fileName.rfind('.');
+			const size_t insertAt = extension != std::string::npos && fileName.find_first_of("/\\", extension) == std::string::npos ? extension : fileName.size();
+			return fileName.substr(0, insertAt) + "_" + number + fileName.substr(insertAt);
+		}
+		const size_t last = fileName.find_first_not_of('#', first);
+		const size_t width = (last == std::string::npos ? fileName.size() : last) - first;
+		if (number.size() < width)
+		{
+			number.insert(0, width - number.size(), '0');
+		}
+		return fileName.substr(0, first) + number + fileName.substr(first + width);
+	}
+
+	// Rodrigues' rotation of vector about the unit length axis
+	Vec3f RotateAboutAxis(const Vec3f& vector, const Vec3f& axis, float angle)
+	{
+		const float cosAngle = std::cos(angle);
+		const float sinAngle = std::sin(angle);
+		return vector * cosAngle + GetCrossProduct(axis, vector) * sinAngle + axis * ((float)GetDotProduct(axis, vector) * (1.f - cosAngle));
+	}
+
+	// jobs can be drawn in the same batch if they only differ in their view of the model
+	bool CanBatch(const RenderJob& first, const RenderJob& other)
+	{
+		return !first.bWireframe && !other.bWireframe
+			&& first.ModelFile == other.ModelFile
+			&& first.CompiledModelFile == other.CompiledModelFile
+			&& first.DiffuseFile == other.DiffuseFile
+			&& first.Size == other.Size
+			&& first.Culling == other.Culling
+			&& first.DiffuseFilter == other.DiffuseFilter;
+	}
+
+	ViewMatrices GetViewMatrices(const RenderJob& job)
+	{
+		const float aspectRatio = job.Size.X / (float)job.Size.Y;
+		ViewMatrices view;
+		view.ViewMatrix = Matrix4x4f::MakeLookAt(job.CameraPosition, job.CameraTarget, job.CameraUp).GetInverse();
+		if (job.bOrthographic)
+		{
+			view.ProjectionMatrix = Matrix4x4f::MakeOrthographicProjection(job.OrthographicWidth, aspectRatio, job.NearClip, job.FarClip);
+		}
+		else
+		{
+			view.ProjectionMatrix = Matrix4x4f::MakePerspectiveProjection(GetRadiansFromDegrees(job.VerticalFieldOfView), aspectRatio, job.NearClip, job.FarClip);
+		}
+		return view;
+	}
+
+	void SetupRasterizer(const RenderJob& job, const Texture* diffuse, Shaders::Rasterizer_SimpleLitDiffuse& outRasterizer)
+	{
+		const ViewMatrices view = GetViewMatrices(job);
+		outRasterizer.ViewMatrix = view.ViewMatrix;
+		outRasterizer.ProjectionMatrix = view.ProjectionMatrix;
+		outRasterizer.Pipeline.Culling = job.Culling;
+		outRasterizer.Diffuse = diffuse;
+		outRasterizer.DiffuseFilter = job.DiffuseFilter;
+		outRasterizer.BaseColour = Colour(255, 255, 255, 255);
+		outRasterizer.LightDirection = outRasterizer.ViewMatrix.TransformVector(job.LightDirection.GetSafeNormal());
+	}
+
+	const Colour ClearColour = Colour(0, 0, 0, 0);
+}
+
+bool TV::Headless::ParseRenderJobOptions(const std::vector<std::string>& arguments, RenderJob& job, std::string& outError)
+{
+	for (size_t index = 0; index != arguments.size(); ++index)
+	{
+		const std::string& option = arguments[index];
+
+		// flags
+		if (option == "--wireframe")
+		{
+			job.bWireframe = true;
+			continue;
+		}
+
+		// everything else takes a value
+		if (index + 1 == arguments.size())
+		{
+			outError = "missing value for " + option;
+			return false;
+		}
+		const std::string& value = arguments[++index];
+
+		bool bValid = true;
+		if (option == "--model")
+		{
+			job.ModelFile = value;
+		}
+		else if (option == "--compiled-model")
+		{
+			job.CompiledModelFile = value;
+		}
+		else if (option == "--diffuse")
+		{
+			job.DiffuseFile = value == "none" ? std::string() : value;
+		}
+		else if (option == "--output")
+		{
+			job.OutputFile = value;
+		}
+		else if (option == "--depth-output")
+		{
+			job.DepthOutputFile = value;
+		}
+		else if (option == "--stats-output")
+		{
+			job.StatsOutputFile = value;
+		}
+		else if (option == "--size")
+		{
+			bValid = ParseSize(value, job.Size);
+		}
+		else if (option == "--camera")
+		{
+			bValid = ParseVec3(value, job.CameraPosition);
+		}
+		else if (option == "--target")
+		{
+			bValid = ParseVec3(value, job.CameraTarget);
+		}
+		else if (option == "--up")
+		{
+			bValid = ParseVec3(value, job.CameraUp);
+		}
+		else if (option == "--fov")
+		{
+			job.bOrthographic = false;
+			bValid = ParseFloat(value, job.VerticalFieldOfView) && job.VerticalFieldOfView > 0.f && job.VerticalFieldOfView < 180.f;
+		}
+		else if (option == "--ortho")
+		{
+			job.bOrthographic = true;
+			bValid = ParseFloat(value, job.OrthographicWidth) && job.OrthographicWidth > 0.f;
+		}
+		else if (option == "--near")
+		{
+			bValid = ParseFloat(value, job.NearClip) && job.NearClip > 0.f;
+		}
+		else if (option == "--far")
+		{
+			bValid = ParseFloat(value, job.FarClip) && job.FarClip > 0.f;
+		}
+		else if (option == "--light")
+		{
+			bValid = ParseVec3(value, job.LightDirection);
+		}
+		else if (option == "--cull")
+		{
+			bValid = ParseCullMode(value, job.Culling);
+		}
+		else if (option == "--filter")
+		{
+			bValid = ParseTextureFilter(value, job.DiffuseFilter);
+		}
+		else if (option == "--turntable")
+		{
+			bValid = ParseInt(value, job.TurntableViews) && job.TurntableViews > 0;
+		}
+		else
+		{
+			outError = "unknown option " + option;
+			return false;
+		}
+
+		if (!bValid)
+		{
+			outError = "invalid value '" + value + "' for " + option;
+			return false;
+		}
+	}
+
+	if (!(job.NearClip < job.FarClip))
+	{
+		outError = "near clip must be closer than far clip";
+		return false;
+	}
+	return true;
+}
+
+std::vector<std::string> TV::Headless::SplitArguments(const std::string& line)
+{
+	std::vector<std::string> arguments;
+	std::string current;
+	bool bInArgument = false;
+	bool bInQuotes = false;
+	for (const char character : line)
+	{
+		if (character == '"')
+		{
+			bInQuotes = !bInQuotes;
+			bInArgument = true;
+		}
+		else if (!bInQuotes && (character == ' ' || character == '\t' || character == '\r'))
+		{
+			if (bInArgument)
+			{
+				arguments.push_back(current);
+				current.clear();
+				bInArgument = false;
+			}
+		}
+		else
+		{
+			current += character;
+			bInArgument = true;
+		}
+	}
+	if (bInArgument)
+	{
+		arguments.push_back(current);
+	}
+	return arguments;
+}
+
+bool TV::Headless::ParseRenderJobFile(const char* fileName, const RenderJob& defaults, std::vector<RenderJob>& outJobs, std::string& outError)
+{
+	std::ifstream file(fileName);
+	if (!file.is_open())
+	{
+		outError = std::string("can't open job file ") + fileName;
+		return false;
+	}
+
+	std::string line;
+	int32 lineNumber = 0;
+	while (std::getline(file, line))
+	{
+		++lineNumber;
+		const std::vector<std::string> arguments = SplitArguments(line);
+		if (arguments.empty() || arguments[0][0] == '#')
+		{
+			continue;
+		}
+
+		RenderJob job = defaults;
+		if (!ParseRenderJobOptions(arguments, job, outError))
+		{
+			outError = std::string(fileName) + ":" + std::to_string(lineNumber) + ": " + outError;
+			return false;
+		}
+		outJobs.push_back(job);
+	}
+	return true;
+}
+
+const char* TV::Headless::GetRenderJobUsage()
+{
+	return
+		"  --model <file.obj>            model to render\n"
+		"  --compiled-model <file>       compiled model cache, rebuilt when out of date\n"
+		"  --diffuse <file.tga|none>     diffuse texture\n"
+		"  --output <file.tga>           image to write\n"
+		"  --depth-output <file.tga>     depth buffer image to write\n"
+		"  --stats-output <file.json>    pipeline statistics of the draw to write\n"
+		"  --size <W>x<H>                image size in pixels\n"
+		"  --camera <x,y,z>              camera position\n"
+		"  --target <x,y,z>              point the camera looks at\n"
+		"  --up <x,y,z>                  camera up direction\n"
+		"  --fov <degrees>               perspective projection with this vertical field of view\n"
+		"  --ortho <width>               orthographic projection this wide\n"
+		"  --near <distance>             near clip plane\n"
+		"  --far <distance>              far clip plane\n"
+		"  --light <x,y,z>               direction towards the light\n"
+		"  --cull <none|back|front>      faces to cull\n"
+		"  --filter <point|bilinear|trilinear>  diffuse texture filtering\n"
+		"  --wireframe                   draw triangle edges only\n"
+		"  --turntable <views>           render this many views turning about the target, numbering the outputs\n";
+}
+
+void TV::Headless::ExpandTurntable(const RenderJob& job, std::vector<RenderJob>& outJobs)
+{
+	if (job.TurntableViews <= 0)
+	{
+		outJobs.push_back(job);
+		return;
+	}
+
+	const Vec3f axis = job.CameraUp.GetSafeNormal();
+	for (int32 viewIndex = 0; viewIndex != job.TurntableViews; ++viewIndex)
+	{
+		const float angle = (float)(2.0 * std::numbers::pi * viewIndex / job.TurntableViews);
+
+		RenderJob view = job;
+		view.TurntableViews = 0;
+		view.CameraPosition = job.CameraTarget + RotateAboutAxis(job.CameraPosition - job.CameraTarget, axis, angle);
+		view.LightDirection = RotateAboutAxis(job.LightDirection, axis, angle);
+		view.OutputFile = GetViewFileName(job.OutputFile, viewIndex);
+		if (!job.DepthOutputFile.empty())
+		{
+			view.DepthOutputFile = GetViewFileName(job.DepthOutputFile, viewIndex);
+		}
+		if (!job.StatsOutputFile.empty())
+		{
+			view.StatsOutputFile = GetViewFileName(job.StatsOutputFile, viewIndex);
+		}
+		outJobs.push_back(view);
+	}
+}
+
+const TV::Renderer::Model* TV::Headless::RenderJobRunner::GetModel(const RenderJob& job, std::string& outError)
+{
+	std::unique_ptr<Model>& model = Models[job.ModelFile + "|" + job.CompiledModelFile];
+	if (model != nullptr)
+	{
+		return model.get();
+	}
+
+	ModelLoadOptions loadOptions;
+	loadOptions.ThreadPool = ThreadPool;
+	loadOptions.bOptimize = true;
+	loadOptions.bVertexStreams = true;
+
+	std::unique_ptr<Model> loaded = std::make_unique<Model>();
+	const bool bLoaded = job.CompiledModelFile.empty()
+		? loaded->LoadWavefrontFile(job.ModelFile.c_str(), loadOptions)
+		: loaded->LoadWavefrontFileCached(job.ModelFile.c_str(), job.CompiledModelFile.c_str(), loadOptions);
+	if (!bLoaded)
+	{
+		outError = "can't load model " + job.ModelFile;
+		return nullptr;
+	}
+	model = std::move(loaded);
+	return model.get();
+}
+
+const TV::Renderer::Texture* TV::Headless::RenderJobRunner::GetTexture(const std::string& fileName, std::string& outError)
+{
+	std::unique_ptr<Texture>& texture = Textures[fileName];
+	if (texture != nullptr)
+	{
+		return texture.get();
+	}
+
+	std::unique_ptr<Texture> built = std::make_unique<Texture>();
+	if (!LoadTexture(fileName.c_str(), *built))
+	{
+		outError = "can't load texture " + fileName;
+		return nullptr;
+	}
+	texture = std::move(built);
+	return texture.get();
+}
+
+bool TV::Headless::RenderJobRunner::Run(const RenderJob& job, std::string& outError)
+{
+	if (job.bWireframe)
+	{
+		return RunWireframe(job, outError);
+	}
+
+	std::vector<std::string> errors;
+	if (RunBatch(&job, 1, errors) != 0)
+	{
+		outError = errors.front();
+		return false;
+	}
+	return true;
+}
+
+TV::int32 TV::Headless::RenderJobRunner::Run(const std::vector<RenderJob>& jobs, std::vector<std::string>& outErrors)
+{
+	int32 numFailed = 0;
+	for (size_t first = 0; first != jobs.size();)
+	{
+		size_t end = first + 1;
+		while (end != jobs.size() && CanBatch(jobs[first], jobs[end]))
+		{
+			++end;
+		}
+
+		if (jobs[first].bWireframe)
+		{
+			std::string error;
+			if (!RunWireframe(jobs[first], error))
+			{
+				outErrors.push_back(error);
+				++numFailed;
+			}
+		}
+		else
+		{
+			numFailed += RunBatch(&jobs[first], (int32)(end - first), outErrors);
+		}
+		first = end;
+	}
+	return numFailed;
+}
+
+TV::int32 TV::Headless::RenderJobRunner::RunBatch(const RenderJob* jobs, int32 numJobs, std::vector<std::string>& outErrors)
+{
+	std::string error;
+	const Model* const model = GetModel(jobs[0], error);
+	const Texture* diffuse = nullptr;
+	if (model != nullptr && !jobs[0].DiffuseFile.empty())
+	{
+		diffuse = GetTexture(jobs[0].DiffuseFile, error);
+	}
+	if (model == nullptr || (diffuse == nullptr && !jobs[0].DiffuseFile.empty()))
+	{
+		outErrors.insert(outErrors.end(), numJobs, error);
+		return numJobs;
+	}
+
+	Shaders::Rasterizer_SimpleLitDiffuse prototype;
+	SetupRasterizer(jobs[0], diffuse, prototype);
+
+	std::vector<ViewMatrices> views(numJobs);
+	for (int32 jobIndex = 0; jobIndex != numJobs; ++jobIndex)
+	{
+		views[jobIndex] = GetViewMatrices(jobs[jobIndex]);
+	}
+
+	// views finish in any order, so failures are kept per view and reported in job order
+	std::vector<std::string> viewErrors(numJobs);
+	const auto setupView = [&](Shaders::Rasterizer_SimpleLitDiffuse& rasterizer, int32 viewIndex)
+	{
+		rasterizer.LightDirection = rasterizer.ViewMatrix.TransformVector(jobs[viewIndex].LightDirection.GetSafeNormal());
+	};
+	const auto onRendered = [&](int32 viewIndex, const RenderTarget& target, const DrawStats& stats)
+	{
+		WriteOutputFiles(jobs[viewIndex], target, true, stats, viewErrors[viewIndex]);
+	};
+	DrawViewBatch(prototype, *model, views, jobs[0].Size, ClearColour, TargetPool, Arena, ThreadPool, setupView, onRendered);
+
+	int32 numFailed = 0;
+	for (const std::string& viewError : viewErrors)
+	{
+		if (!viewError.empty())
+		{
+			outErrors.push_back(viewError);
+			++numFailed;
+		}
+	}
+	return numFailed;
+}
+
+bool TV::Headless::RenderJobRunner::RunWireframe(const RenderJob& job, std::string& outError)
+{
+	const Model* const model = GetModel(job, outError);
+	if (model == nullptr)
+	{
+		return false;
+	}
+
+	Shaders::Rasterizer_SimpleLitDiffuse rasterizer;
+	SetupRasterizer(job, nullptr, rasterizer);
+
+	std::unique_ptr<RenderTarget> target = TargetPool.Acquire(job.Size);
+	target->Clear(ClearColour);
+	Arena.Reset();
+	RenderContext context = target->GetRenderContext(ThreadPool);
+	context.DepthBuffer = nullptr;
+	context.Arena = &Arena;
+	const DrawStats& stats = rasterizer.DrawModelWireframe(*model, context, Colour(255, 255, 255, 255));
+
+	const bool bWritten = WriteOutputFiles(job, *target, false, stats, outError);
+	TargetPool.Release(std::move(target));
+	return bWritten;
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "../Maths/Types.h"
+#include "../Maths/Vec2.h"
+#include "../Maths/Vec3.h"
+#include "../Model/Model.h"
+#include "../Renderer/FrameArena.h"
+#include "../Renderer/PipelineState.h"
+#include "../Renderer/RenderTargetPool.h"
+#include "../Renderer/Texture.h"
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace TV
+{
+	namespace Headless
+	{
+		using namespace Maths;
+		using namespace Renderer;
+
+		// everything needed to render one image. Paths are relative to the working directory
+		struct RenderJob
+		{
+			std::string ModelFile = "Content/african_head.obj";
+			std::string CompiledModelFile; // optional, the compiled model is used if it is up to date and rewritten if not
+			std::string DiffuseFile = "Content/african_head_diffuse.tga"; // optional
+			std::string OutputFile = "output.tga"; // for turntables, a run of # in this or the other output names is replaced by the zero padded view number
+			std::string DepthOutputFile; // optional
+			std::string StatsOutputFile; // optional, the draw's pipeline statistics as JSON
+
+			Vec2i Size = Vec2i(600, 800);
+
+			Vec3f CameraPosition = Vec3f(1.f, 1.f, 3.f);
+			Vec3f CameraTarget;
+			Vec3f CameraUp = Vec3f(0.f, 1.f, 0.f);
+
+			bool bOrthographic = false;
+			float VerticalFieldOfView = 30.f; // degrees, for perspective projection
+			float OrthographicWidth = 2.f;
+			float NearClip = 0.1f;
+			float FarClip = 1000.f;
+
+			Vec3f LightDirection = Vec3f(1.f, 1.f, 1.f); // world space, towards the light
+
+			bool bWireframe = false;
+			CullMode Culling = CullMode::Back;
+			TextureFilter DiffuseFilter = TextureFilter::Trilinear;
+
+			int32 TurntableViews = 0; // if set, the job is expanded by ExpandTurntable into this many views around the target
+		};
+
+		// Applies command line style options ("--size 640x480 --output a.tga ...") on top of job, returns false with a message in
+		// outError if any are unknown or malformed. Options are listed by GetRenderJobUsage
+		bool ParseRenderJobOptions(const std::vector<std::string>& arguments, RenderJob& job, std::string& outError);
+
+		// Reads a job file with one job per line, each given as options applied on top of defaults.
+		// Blank lines and lines starting with # are skipped, and arguments containing spaces can be double quoted
+		bool ParseRenderJobFile(const char* fileName, const RenderJob& defaults, std::vector<RenderJob>& outJobs, std::string& outError);
+
+		// splits a line into arguments at whitespace, keeping double quoted runs together
+		std::vector<std::string> SplitArguments(const std::string& line);
+
+		const char* GetRenderJobUsage();
+
+		// Appends the job to outJobs, or if it is a turntable, a job for each of its views. The camera and light turn together
+		// about the up axis through the target, so the model appears to turn in front of them
+		void ExpandTurntable(const RenderJob& job, std::vector<RenderJob>& outJobs);
+
+		// Renders jobs, keeping the models and textures they load so later jobs using the same files don't load them again
+		class RenderJobRunner
+		{
+		public:
+			explicit RenderJobRunner(Renderer::ThreadPool* threadPool) : ThreadPool(threadPool) {}
+
+			// renders the job and writes its output files, returns false with a message in outError on failure
+			bool Run(const RenderJob& job, std::string& outError);
+
+			// Renders all the jobs. Runs of consecutive jobs which draw the same model the same way, differing only in their camera,
+			// light and output files, are drawn as one batch of views in parallel. Returns the number of jobs which failed, with
+			// a message for each in outErrors
+			int32 Run(const std::vector<RenderJob>& jobs, std::vector<std::string>& outErrors);
+
+		private:
+			// renders jobs which CanBatch says can be drawn together, outErrors gets a message for each that fails
+			int32 RunBatch(const RenderJob* jobs, int32 numJobs, std::vector<std::string>& outErrors);
+			bool RunWireframe(const RenderJob& job, std::string& outError);
+
+			const Model* GetModel(const RenderJob& job, std::string& outError);
+			const Texture* GetTexture(const std::string& fileName, std::string& outError);
+
+			Renderer::ThreadPool* ThreadPool = nullptr;
+			RenderTargetPool TargetPool;
+			FrameArena Arena;
+			std::unordered_map<std::string, std::unique_ptr<Model>> Models;
+			std::unordered_map<std::string, std::unique_ptr<Texture>> Textures;
+		};
+	}
+}
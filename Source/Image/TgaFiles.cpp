@@ -0,0 +1,66 @@
+#include "TgaFiles.h"
+#include "TgaImage.h"
+
+bool TV::Renderer::WriteCanvasTga(const ICanvas& canvas, const char* fileName)
+{
+	const Vec2i size = canvas.GetSize();
+	TGAImage image(size.X, size.Y, TGAImage::RGB);
+	const int32 bytesPerPixel = GetBytesPerPixel(canvas.GetPixelFormat());
+	for (int32 y = 0; y != size.Y; ++y)
+	{
+		uint8* destination = image.GetRowData(size.Y - 1 - y);
+		const uint8* source = canvas.GetRowData(y);
+		if (source == nullptr || bytesPerPixel < 3)
+		{
+			for (int32 x = 0; x != size.X; ++x, destination += 3)
+			{
+				const Colour colour = canvas.GetPixel(Vec2i(x, y));
+				destination[0] = colour.Raw[0];
+				destination[1] = colour.Raw[1];
+				destination[2] = colour.Raw[2];
+			}
+			continue;
+		}
+		for (int32 x = 0; x != size.X; ++x, source += bytesPerPixel, destination += 3)
+		{
+			destination[0] = source[0];
+			destination[1] = source[1];
+			destination[2] = source[2];
+		}
+	}
+	return image.write_tga_file(fileName);
+}
+
+std::unique_ptr<TV::Renderer::MemoryCanvas> TV::Renderer::ReadCanvasTga(const char* fileName)
+{
+	TGAImage image;
+	if (!image.read_tga_file(fileName) || (image.get_bytespp() != TGAImage::RGB && image.get_bytespp() != TGAImage::RGBA))
+	{
+		return nullptr;
+	}
+
+	const Vec2i size(image.get_width(), image.get_height());
+	const int32 bytesPerPixel = image.get_bytespp();
+	std::unique_ptr<MemoryCanvas> canvas = std::make_unique<MemoryCanvas>(size);
+	for (int32 y = 0; y != size.Y; ++y)
+	{
+		const uint8* source = image.GetRowData(size.Y - 1 - y);
+		for (int32 x = 0; x != size.X; ++x, source += bytesPerPixel)
+		{
+			canvas->SetPixel(Vec2i(x, y), Colour(source[2], source[1], source[0]));
+		}
+	}
+	return canvas;
+}
+
+bool TV::Renderer::LoadTexture(const char* fileName, Texture& outTexture)
+{
+	TGAImage image;
+	if (!image.read_tga_file(fileName))
+	{
+		return false;
+	}
+	// tex coords have v up
+	image.flip_vertically();
+	return outTexture.Build(image);
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "../Renderer/ICanvas.h"
+#include "../Renderer/MemoryCanvas.h"
+#include "../Renderer/Texture.h"
+
+#include <memory>
+
+namespace TV
+{
+	namespace Renderer
+	{
+		// Canvases have y up, so their images are written with the origin at the bottom left and read back the same way.
+		// Only the colour is kept, as 24 bit RGB
+		bool WriteCanvasTga(const ICanvas& canvas, const char* fileName);
+
+		// reads a 24 or 32 bit image, returns nullptr if it can't be read
+		std::unique_ptr<MemoryCanvas> ReadCanvasTga(const char* fileName);
+
+		// Reads an image and builds a texture from it. Tex coords have v up, so the image is flipped to match
+		bool LoadTexture(const char* fileName, Texture& outTexture);
+	}
+}
@@ -1,5 +1,7 @@
-#include "tgaimage.h"
+#include "TgaImage.h"
 
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 
 TGAImage::TGAImage() : data(NULL), width(0), height(0), bytespp(0) {
@@ -9,6 +11,7 @@ TGAImage::TGAImage(int w, int h, int bpp) : data(NULL), width(w), height(h), byt
 	unsigned long nbytes = width * height * bytespp;
 	data = new unsigned char[nbytes];
 	memset(data, 0, nbytes);
+	update_canvas_memory();
 }
 
 TGAImage::TGAImage(const TGAImage& img) {
@@ -18,6 +21,7 @@ TGAImage::TGAImage(const TGAImage& img) {
 	unsigned long nbytes = width * height * bytespp;
 	data = new unsigned char[nbytes];
 	memcpy(data, img.data, nbytes);
+	update_canvas_memory();
 }
 
 TGAImage::~TGAImage() {
@@ -33,6 +37,7 @@ TGAImage& TGAImage::operator =(const TGAImage& img) {
 		unsigned long nbytes = width * height * bytespp;
 		data = new unsigned char[nbytes];
 		memcpy(data, img.data, nbytes);
+		update_canvas_memory();
 	}
 	return *this;
 }
@@ -40,6 +45,7 @@ TGAImage& TGAImage::operator =(const TGAImage& img) {
 bool TGAImage::read_tga_file(const char* filename) {
 	if (data) delete[] data;
 	data = NULL;
+	update_canvas_memory();
 	std::ifstream in;
 	in.open(filename, std::ios::binary);
 	if (!in.is_open()) {
@@ -64,6 +70,7 @@ bool TGAImage::read_tga_file(const char* filename) {
 	}
 	unsigned long nbytes = bytespp * width * height;
 	data = new unsigned char[nbytes];
+	update_canvas_memory();
 	if (3 == header.datatypecode || 2 == header.datatypecode) {
 		in.read((char*)data, nbytes);
 		if (!in.good()) {
@@ -90,7 +97,6 @@ bool TGAImage::read_tga_file(const char* filename) {
 	if (header.imagedescriptor & 0x10) {
 		flip_horizontally();
 	}
-	std::cerr << width << "x" << height << "/" << bytespp * 8 << "\n";
 	in.close();
 	return true;
 }
@@ -294,16 +300,13 @@ bool TGAImage::flip_horizontally() {
 bool TGAImage::flip_vertically() {
 	if (!data) return false;
 	unsigned long bytes_per_line = width * bytespp;
-	unsigned char* line = new unsigned char[bytes_per_line];
 	int half = height >> 1;
 	for (int j = 0; j < half; j++) {
-		unsigned long l1 = j * bytes_per_line;
-		unsigned long l2 = (height - 1 - j) * bytes_per_line;
-		memmove((void*)line, (void*)(data + l1), bytes_per_line);
-		memmove((void*)(data + l1), (void*)(data + l2), bytes_per_line);
-		memmove((void*)(data + l2), (void*)line, bytes_per_line);
+		// swapped in place rather than through a line buffer, so flipping doesn't allocate
+		unsigned char* l1 = data + j * bytes_per_line;
+		unsigned char* l2 = data + (height - 1 - j) * bytes_per_line;
+		std::swap_ranges(l1, l1 + bytes_per_line, l2);
 	}
-	delete[] line;
 	return true;
 }
 
@@ -349,5 +352,16 @@ bool TGAImage::scale(int w, int h) {
 	data = tdata;
 	width = w;
 	height = h;
+	update_canvas_memory();
 	return true;
+}
+
+void TGAImage::update_canvas_memory() {
+	TV::Renderer::PixelFormat format = TV::Renderer::PixelFormat::Unknown;
+	switch (bytespp) {
+	case GRAYSCALE: format = TV::Renderer::PixelFormat::Grayscale8; break;
+	case RGB: format = TV::Renderer::PixelFormat::BGR8; break;
+	case RGBA: format = TV::Renderer::PixelFormat::BGRA8; break;
+	}
+	SetMemory(data, TV::Maths::Vec2i(width, height), width * bytespp, format);
 }
\ No newline at end of file
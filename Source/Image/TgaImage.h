@@ -34,6 +34,7 @@ protected:
 
 	bool   load_rle_data(std::ifstream& in);
 	bool unload_rle_data(std::ofstream& out);
+	void update_canvas_memory();
 public:
 	enum Format {
 		GRAYSCALE = 1, RGB = 3, RGBA = 4
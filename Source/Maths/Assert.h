@@ -8,7 +8,11 @@ namespace TV
 		{
 			if (!bCondition)
 			{
+#if defined(_MSC_VER)
 				__debugbreak();
+#else
+				__builtin_trap();
+#endif
 			}
 		}
 
@@ -1,6 +1,7 @@
 #pragma once
 
-#include <xutility>
+#include <algorithm>
+#include <cstdlib>
 #include "Types.h"
 #include "Maths.h"
 
@@ -55,19 +56,19 @@ namespace TV
 				return newColour;
 			}
 
-			static [[nodiscard]] Colour MakeRandomColour()
+			[[nodiscard]] static Colour MakeRandomColour()
 			{
 				return Colour(rand() % 255, rand() % 255, rand() % 255, rand() % 255);
 			}
 
-			static [[nodiscard]] Colour MakeFromRGBA(uint32 rgba)
+			[[nodiscard]] static Colour MakeFromRGBA(uint32 rgba)
 			{
 				const uint32 mask = 0xFF;
 				const Colour newColour((rgba >> 24) & mask, (rgba >> 16) & mask, (rgba >> 8) & mask, rgba & mask);
 				return newColour;
 			}
 
-			static [[nodiscard]] Colour MakeFromARGB(uint32 rgba)
+			[[nodiscard]] static Colour MakeFromARGB(uint32 rgba)
 			{
 				const uint32 mask = 0xFF;
 				const Colour newColour((rgba >> 16) & mask, (rgba >> 8) & mask, rgba & mask, (rgba >> 24) & mask);
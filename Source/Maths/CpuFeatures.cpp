@@ -0,0 +1,73 @@
+#include "CpuFeatures.h"
+
+#if TV_SIMD_X86 && defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace
+{
+	TV::Maths::CpuFeatures QueryCpuFeatures()
+	{
+		TV::Maths::CpuFeatures features;
+
+#if TV_SIMD_X86 && defined(_MSC_VER)
+		int registers[4] = {}; // eax, ebx, ecx, edx
+		__cpuid(registers, 0);
+		const int maxLeaf = registers[0];
+
+		if (maxLeaf >= 1)
+		{
+			__cpuid(registers, 1);
+			features.bSSE2 = (registers[3] & (1 << 26)) != 0;
+			features.bSSE41 = (registers[2] & (1 << 19)) != 0;
+			features.bFMA = (registers[2] & (1 << 12)) != 0;
+
+			// avx also needs the os to save the ymm registers on context switches
+			const bool bOSXSave = (registers[2] & (1 << 27)) != 0;
+			const bool bCpuAVX = (registers[2] & (1 << 28)) != 0;
+			features.bAVX = bOSXSave && bCpuAVX && (_xgetbv(0) & 0x6) == 0x6;
+			features.bFMA = features.bFMA && features.bAVX;
+		}
+		if (maxLeaf >= 7 && features.bAVX)
+		{
+			__cpuidex(registers, 7, 0);
+			features.bAVX2 = (registers[1] & (1 << 5)) != 0;
+		}
+#elif TV_SIMD_X86 && defined(__GNUC__)
+		// these already account for os support
+		__builtin_cpu_init();
+		features.bSSE2 = __builtin_cpu_supports("sse2");
+		features.bSSE41 = __builtin_cpu_supports("sse4.1");
+		features.bAVX = __builtin_cpu_supports("avx");
+		features.bAVX2 = __builtin_cpu_supports("avx2");
+		features.bFMA = __builtin_cpu_supports("fma");
+#endif
+
+		return features;
+	}
+}
+
+TV::Maths::SimdLevel TV::Maths::CpuFeatures::GetSimdLevel() const
+{
+	if (bAVX2)
+	{
+		return SimdLevel::AVX2;
+	}
+	if (bSSE2)
+	{
+		return SimdLevel::SSE2;
+	}
+	return SimdLevel::Scalar;
+}
+
+const TV::Maths::CpuFeatures& TV::Maths::CpuFeatures::Get()
+{
+	static const CpuFeatures features = QueryCpuFeatures();
+	return features;
+}
+
+TV::Maths::SimdLevel TV::Maths::GetSupportedSimdLevel(SimdLevel requested)
+{
+	const SimdLevel supported = CpuFeatures::Get().GetSimdLevel();
+	return (int32)requested < (int32)supported ? requested : supported;
+}
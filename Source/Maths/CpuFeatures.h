@@ -0,0 +1,49 @@
+#pragma once
+
+#include "Types.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define TV_SIMD_X86 1
+#else
+#define TV_SIMD_X86 0
+#endif
+
+// functions using intrinsics above the compiler's baseline need to be tagged on gcc/clang, msvc allows them anywhere
+#if defined(__GNUC__) && TV_SIMD_X86
+#define TV_TARGET_SSE2 __attribute__((target("sse2")))
+#define TV_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define TV_TARGET_SSE2
+#define TV_TARGET_AVX2
+#endif
+
+namespace TV
+{
+	namespace Maths
+	{
+		enum class SimdLevel
+		{
+			Scalar,
+			SSE2,
+			AVX2,
+		};
+
+		struct CpuFeatures
+		{
+			bool bSSE2 = false;
+			bool bSSE41 = false;
+			bool bAVX = false;
+			bool bAVX2 = false;
+			bool bFMA = false;
+
+			// highest level supported by both the cpu and the os
+			SimdLevel GetSimdLevel() const;
+
+			// queried once via cpuid
+			static const CpuFeatures& Get();
+		};
+
+		// clamps the requested level to what the cpu supports
+		SimdLevel GetSupportedSimdLevel(SimdLevel requested);
+	}
+}
@@ -38,6 +38,39 @@ TV::Maths::Vec3f TV::Maths::ComputeBarycentricCoordinate(const Vec2f& p, const V
 #endif
 }
 
+bool TV::Maths::ComputeBarycentricDerivatives(const Vec2f& a, const Vec2f& b, const Vec2f& c, Vec3f& outDX, Vec3f& outDY)
+{
+	const float doubleArea = GetCrossProduct(b - a, c - a);
+	if (!(doubleArea != 0.f))
+	{
+		return false;
+	}
+
+	// each coordinate is the area of the sub triangle opposite its vertex, which changes along the perpendicular of that edge
+	const float invDoubleArea = 1.f / doubleArea;
+	outDX = Vec3f(b.Y - c.Y, c.Y - a.Y, a.Y - b.Y) * invDoubleArea;
+	outDY = Vec3f(c.X - b.X, a.X - c.X, b.X - a.X) * invDoubleArea;
+	return true;
+}
+
+TV::Maths::Vec3f TV::Maths::ComputePerspectiveBarycentric(const Vec3f& screenBarycentric, const Vec3f& vertexInvW)
+{
+	Vec3f barycentric = screenBarycentric;
+	barycentric *= vertexInvW;
+	return barycentric / (barycentric.X + barycentric.Y + barycentric.Z);
+}
+
+void TV::Maths::ComputePerspectiveBarycentricDerivatives(const Vec3f& barycentric, const Vec3f& vertexW, const Vec3f& invWDX, const Vec3f& invWDY, Vec3f& outDX, Vec3f& outDY)
+{
+	// each coordinate is (b/w) / q where q = sum(b/w) is the interpolated 1/w, so by the quotient rule
+	// d/dx = (d(b/w)/dx - coordinate * dq/dx) / q, and 1/q is the interpolated w
+	const float w = barycentric.X * vertexW.X + barycentric.Y * vertexW.Y + barycentric.Z * vertexW.Z;
+	const float invWSumDX = invWDX.X + invWDX.Y + invWDX.Z;
+	const float invWSumDY = invWDY.X + invWDY.Y + invWDY.Z;
+	outDX = (invWDX - barycentric * invWSumDX) * w;
+	outDY = (invWDY - barycentric * invWSumDY) * w;
+}
+
 bool TV::Maths::PointInPoly2D(const Vec2f& p, const Vec2f& a, const Vec2f& b, const Vec2f& c)
 {
 	const Vec3f barycentric = ComputeBarycentricCoordinate(p, a, b, c);
@@ -9,6 +9,17 @@ namespace TV
 	{
 		Vec3f ComputeBarycentricCoordinate(const Vec2f& p, const Vec2f& a, const Vec2f& b, const Vec2f& c);
 
+		// change in the barycentric coordinates of triangle abc for a unit step in x and in y, returns false if it has no area
+		bool ComputeBarycentricDerivatives(const Vec2f& a, const Vec2f& b, const Vec2f& c, Vec3f& outDX, Vec3f& outDY);
+
+		// Barycentric coordinates of the point on the triangle in clip space, from those on its projection and the reciprocal of
+		// each vertex's clip space w. Attributes blended with these are perspective correct
+		Vec3f ComputePerspectiveBarycentric(const Vec3f& screenBarycentric, const Vec3f& vertexInvW);
+
+		// change in perspective correct barycentric coordinates for a unit step in x and in y, from their value, each vertex's clip space w,
+		// and the screen space barycentric derivatives multiplied by each vertex's 1/w
+		void ComputePerspectiveBarycentricDerivatives(const Vec3f& barycentric, const Vec3f& vertexW, const Vec3f& invWDX, const Vec3f& invWDY, Vec3f& outDX, Vec3f& outDY);
+
 		bool PointInPoly2D(const Vec2f& p, const Vec2f& a, const Vec2f& b, const Vec2f& c);
 
 		template<class T>
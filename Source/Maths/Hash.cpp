@@ -0,0 +1,84 @@
+#include "Hash.h"
+
+#include <cstring>
+
+namespace
+{
+	using namespace TV;
+
+	// constants and rounds as used by xxHash64
+	constexpr uint64 Prime1 = 0x9E3779B185EBCA87ull;
+	constexpr uint64 Prime2 = 0xC2B2AE3D27D4EB4Full;
+	constexpr uint64 Prime3 = 0x165667B19E3779F9ull;
+	constexpr uint64 Prime4 = 0x85EBCA77C2B2AE63ull;
+	constexpr uint64 Prime5 = 0x27D4EB2F165667C5ull;
+
+	uint64 RotateLeft(uint64 value, int32 bits)
+	{
+		return (value << bits) | (value >> (64 - bits));
+	}
+
+	uint64 ReadWord(const uint8* data)
+	{
+		uint64 word;
+		std::memcpy(&word, data, sizeof(word));
+		return word;
+	}
+
+	uint64 Round(uint64 accumulator, uint64 word)
+	{
+		return RotateLeft(accumulator + word * Prime2, 31) * Prime1;
+	}
+
+	uint64 MergeRound(uint64 hash, uint64 accumulator)
+	{
+		return (hash ^ Round(0, accumulator)) * Prime1 + Prime4;
+	}
+}
+
+TV::uint64 TV::Maths::ComputeHash(const void* data, size_t size, uint64 seed)
+{
+	const uint8* bytes = (const uint8*)data;
+	const uint8* const end = bytes + size;
+
+	uint64 hash;
+	if (size >= 32)
+	{
+		// four independent lanes so the multiplies can overlap
+		uint64 lanes[4] = { seed + Prime1 + Prime2, seed + Prime2, seed, seed - Prime1 };
+		for (; bytes + 32 <= end; bytes += 32)
+		{
+			for (int32 laneIndex = 0; laneIndex != 4; ++laneIndex)
+			{
+				lanes[laneIndex] = Round(lanes[laneIndex], ReadWord(bytes + laneIndex * 8));
+			}
+		}
+
+		hash = RotateLeft(lanes[0], 1) + RotateLeft(lanes[1], 7) + RotateLeft(lanes[2], 12) + RotateLeft(lanes[3], 18);
+		for (const uint64 lane : lanes)
+		{
+			hash = MergeRound(hash, lane);
+		}
+	}
+	else
+	{
+		hash = seed + Prime5;
+	}
+	hash += (uint64)size;
+
+	for (; bytes + 8 <= end; bytes += 8)
+	{
+		hash = RotateLeft(hash ^ Round(0, ReadWord(bytes)), 27) * Prime1 + Prime4;
+	}
+	for (; bytes != end; ++bytes)
+	{
+		hash = RotateLeft(hash ^ (*bytes * Prime5), 11) * Prime1;
+	}
+
+	hash ^= hash >> 33;
+	hash *= Prime2;
+	hash ^= hash >> 29;
+	hash *= Prime3;
+	hash ^= hash >> 32;
+	return hash;
+}
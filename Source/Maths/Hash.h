@@ -0,0 +1,14 @@
+#pragma once
+
+#include "Types.h"
+
+#include <cstddef>
+
+namespace TV
+{
+	namespace Maths
+	{
+		// Fast non-cryptographic 64 bit hash of a block of memory, for identifying content rather than security
+		uint64 ComputeHash(const void* data, size_t size, uint64 seed = 0);
+	}
+}
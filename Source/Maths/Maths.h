@@ -9,19 +9,19 @@ namespace TV
 	namespace Maths
 	{
 		template<class T>
-		inline [[nodiscard]] T GetSign(const T& a)
+		[[nodiscard]] inline T GetSign(const T& a)
 		{
 			return (a >= T(0)) ? T(1) : T(-1);
 		}
 
 		template<class T>
-		inline [[nodiscard]] T GetAbs(const T& a)
+		[[nodiscard]] inline T GetAbs(const T& a)
 		{
 			return GetSign(a) * a;
 		}
 
 		template<class T>
-		inline [[nodiscard]] T GetFloor(T a)
+		[[nodiscard]] inline T GetFloor(T a)
 		{
 			const T sign = GetSign(a);
 			const T abs = sign * a;
@@ -30,10 +30,10 @@ namespace TV
 		}
 
 		template<class T>
-		inline [[nodiscard]] int32 GetFloorToInt(T a) { return (int32)GetFloor(a); }
+		[[nodiscard]] inline int32 GetFloorToInt(T a) { return (int32)GetFloor(a); }
 
 		template<class T>
-		inline [[nodiscard]] T GetCeil(T a)
+		[[nodiscard]] inline T GetCeil(T a)
 		{
 			const T sign = GetSign(a);
 			const T abs = sign * a;
@@ -49,10 +49,10 @@ namespace TV
 		}
 
 		template<class T>
-		inline [[nodiscard]] int32 GetCeilToInt(T a) { return (int32)GetCeil(a); }
+		[[nodiscard]] inline int32 GetCeilToInt(T a) { return (int32)GetCeil(a); }
 
 		template<class T>
-		inline [[nodiscard]] int32 GetRoundToInt(T a)
+		[[nodiscard]] inline int32 GetRoundToInt(T a)
 		{
 			const T sign = GetSign(a);
 			const T abs = a * sign;
@@ -62,47 +62,47 @@ namespace TV
 			return absRounded * (int32)sign;
 		}
 
-		inline [[nodiscard]] float GetSqrt(float val) { return std::sqrt(val); }
-		inline [[nodiscard]] double GetSqrt(double val) { return std::sqrt(val); }
+		[[nodiscard]] inline float GetSqrt(float val) { return std::sqrt(val); }
+		[[nodiscard]] inline double GetSqrt(double val) { return std::sqrt(val); }
 
 		template<class T>
-		inline [[nodiscard]] T GetMin(const T& a, const T& b)
+		[[nodiscard]] inline T GetMin(const T& a, const T& b)
 		{
 			return (a > b) ? b : a;
 		}
 
 		template<class T>
-		inline [[nodiscard]] T GetMin(const T& a, const T& b, const T& c)
+		[[nodiscard]] inline T GetMin(const T& a, const T& b, const T& c)
 		{
 			return GetMin(GetMin(a, b), c);
 		}
 
 		template<class T>
-		inline [[nodiscard]] T GetMax(const T& a, const T& b)
+		[[nodiscard]] inline T GetMax(const T& a, const T& b)
 		{
 			return (a > b) ? a : b;
 		}
 
 		template<class T>
-		inline [[nodiscard]] T GetMax(const T& a, const T& b, const T& c)
+		[[nodiscard]] inline T GetMax(const T& a, const T& b, const T& c)
 		{
 			return GetMax(GetMax(a, b), c);
 		}
 
 		template<class T>
-		inline [[nodiscard]] T GetClamped(const T& a, const T& lowerBound, const T& upperBound)
+		[[nodiscard]] inline T GetClamped(const T& a, const T& lowerBound, const T& upperBound)
 		{
 			return GetMin(upperBound, GetMax(lowerBound, a));
 		}
 
 		template<class T, class U>
-		inline [[nodiscard]] T GetLerp(const T& a, const T& b, U alpha)
+		[[nodiscard]] inline T GetLerp(const T& a, const T& b, U alpha)
 		{
 			return T(a + (b - a) * alpha);
 		}
 
 		template<class T>
-		inline [[nodiscard]] T GetRangePct(const T& a, const T& b, const T& value)
+		[[nodiscard]] inline T GetRangePct(const T& a, const T& b, const T& value)
 		{
 			const T range = b - a;
 			if (GetAbs(range) < C_SmallNumber)
@@ -112,16 +112,16 @@ namespace TV
 			return (value - a) / range;
 		}
 
-		inline [[nodiscard]] float GetSinRadians(float a) { return std::sinf(a); }
-		inline [[nodiscard]] double GetSinRadians(double a) { return std::sin(a); }
+		[[nodiscard]] inline float GetSinRadians(float a) { return std::sin(a); }
+		[[nodiscard]] inline double GetSinRadians(double a) { return std::sin(a); }
 
-		inline [[nodiscard]] float GetCosRadians(float a) { return std::cosf(a); }
-		inline [[nodiscard]] double GetCosRadians(double a) { return std::cos(a); }
+		[[nodiscard]] inline float GetCosRadians(float a) { return std::cos(a); }
+		[[nodiscard]] inline double GetCosRadians(double a) { return std::cos(a); }
 
-		inline [[nodiscard]] float GetTanRadians(float a) { return std::tanf(a); }
-		inline [[nodiscard]] double GetTanRadians(double a) { return std::tan(a); }
+		[[nodiscard]] inline float GetTanRadians(float a) { return std::tan(a); }
+		[[nodiscard]] inline double GetTanRadians(double a) { return std::tan(a); }
 
-		inline constexpr [[nodiscard]] float GetRadiansFromDegrees(float a) { return (float)(std::numbers::pi * a / 180.f); }
-		inline constexpr [[nodiscard]] double GetRadiansFromDegrees(double a) { return std::numbers::pi * a / 180.0; }
+		[[nodiscard]] inline constexpr float GetRadiansFromDegrees(float a) { return (float)(std::numbers::pi * a / 180.f); }
+		[[nodiscard]] inline constexpr double GetRadiansFromDegrees(double a) { return std::numbers::pi * a / 180.0; }
 	}
 }
\ No newline at end of file
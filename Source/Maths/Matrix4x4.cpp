@@ -1 +1,103 @@
 #include "Matrix4x4.h"
+
+#if TV_SIMD_X86
+
+namespace
+{
+	// result lanes are (a[x], a[y], b[z], b[w])
+	template<int X, int Y, int Z, int W>
+	__m128 Shuffle(__m128 a, __m128 b)
+	{
+		return _mm_shuffle_ps(a, b, _MM_SHUFFLE(W, Z, Y, X));
+	}
+
+	template<int X, int Y, int Z, int W>
+	__m128 Swizzle(__m128 a)
+	{
+		return Shuffle<X, Y, Z, W>(a, a);
+	}
+
+	// 2x2 matrices are held row major in one register
+
+	// a * b
+	__m128 Mat2Mul(__m128 a, __m128 b)
+	{
+		return _mm_add_ps(_mm_mul_ps(a, Swizzle<0, 3, 0, 3>(b)), _mm_mul_ps(Swizzle<1, 0, 3, 2>(a), Swizzle<2, 1, 2, 1>(b)));
+	}
+
+	// adjugate(a) * b
+	__m128 Mat2AdjMul(__m128 a, __m128 b)
+	{
+		return _mm_sub_ps(_mm_mul_ps(Swizzle<3, 3, 0, 0>(a), b), _mm_mul_ps(Swizzle<1, 1, 2, 2>(a), Swizzle<2, 3, 0, 1>(b)));
+	}
+
+	// a * adjugate(b)
+	__m128 Mat2MulAdj(__m128 a, __m128 b)
+	{
+		return _mm_sub_ps(_mm_mul_ps(a, Swizzle<3, 0, 3, 0>(b)), _mm_mul_ps(Swizzle<1, 0, 3, 2>(a), Swizzle<2, 1, 2, 1>(b)));
+	}
+}
+
+template<>
+TV::Maths::TMatrix4x4<float> TV::Maths::TMatrix4x4<float>::GetInverse() const
+{
+	// https://lxjk.github.io/2017/09/03/Fast-4x4-Matrix-Inverse-with-SSE-SIMD-Explained.html
+	// With M split into 2x2 blocks | A B |, the inverse is 1/|M| * | X Y | where
+	//                              | C D |                         | Z W |
+	// X# = |D|A - B(D#C), Y# = |B|C - D(A#B)#, Z# = |C|B - A(D#C)#, W# = |A|D - C(A#B)#
+	// and |M| = |A||D| + |B||C| - tr((A#B)(D#C))
+
+	const __m128 row0 = _mm_load_ps(M[0]);
+	const __m128 row1 = _mm_load_ps(M[1]);
+	const __m128 row2 = _mm_load_ps(M[2]);
+	const __m128 row3 = _mm_load_ps(M[3]);
+
+	const __m128 a = _mm_movelh_ps(row0, row1);
+	const __m128 b = _mm_movehl_ps(row1, row0);
+	const __m128 c = _mm_movelh_ps(row2, row3);
+	const __m128 d = _mm_movehl_ps(row3, row2);
+
+	// (|A|, |B|, |C|, |D|)
+	const __m128 subDeterminants = _mm_sub_ps(
+		_mm_mul_ps(Shuffle<0, 2, 0, 2>(row0, row2), Shuffle<1, 3, 1, 3>(row1, row3)),
+		_mm_mul_ps(Shuffle<1, 3, 1, 3>(row0, row2), Shuffle<0, 2, 0, 2>(row1, row3)));
+	const __m128 detA = Swizzle<0, 0, 0, 0>(subDeterminants);
+	const __m128 detB = Swizzle<1, 1, 1, 1>(subDeterminants);
+	const __m128 detC = Swizzle<2, 2, 2, 2>(subDeterminants);
+	const __m128 detD = Swizzle<3, 3, 3, 3>(subDeterminants);
+
+	const __m128 adjDMulC = Mat2AdjMul(d, c);
+	const __m128 adjAMulB = Mat2AdjMul(a, b);
+
+	__m128 x = _mm_sub_ps(_mm_mul_ps(detD, a), Mat2Mul(b, adjDMulC));
+	__m128 w = _mm_sub_ps(_mm_mul_ps(detA, d), Mat2Mul(c, adjAMulB));
+	__m128 y = _mm_sub_ps(_mm_mul_ps(detB, c), Mat2MulAdj(d, adjAMulB));
+	__m128 z = _mm_sub_ps(_mm_mul_ps(detC, b), Mat2MulAdj(a, adjDMulC));
+
+	__m128 trace = _mm_mul_ps(adjAMulB, Swizzle<0, 2, 1, 3>(adjDMulC));
+	trace = _mm_add_ps(trace, Swizzle<2, 3, 0, 1>(trace));
+	trace = _mm_add_ps(trace, Swizzle<1, 0, 3, 2>(trace));
+
+	const __m128 determinant = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(detA, detD), _mm_mul_ps(detB, detC)), trace);
+	if (_mm_cvtss_f32(determinant) == 0.f)
+	{
+		return TMatrix4x4<float>();
+	}
+
+	// the signs turn the adjugates above back into the blocks' contributions
+	const __m128 scale = _mm_div_ps(_mm_setr_ps(1.f, -1.f, -1.f, 1.f), determinant);
+	x = _mm_mul_ps(x, scale);
+	y = _mm_mul_ps(y, scale);
+	z = _mm_mul_ps(z, scale);
+	w = _mm_mul_ps(w, scale);
+
+	// undo the adjugates' swap of the diagonals while reassembling the rows
+	TMatrix4x4<float> inv;
+	_mm_store_ps(inv.M[0], Shuffle<3, 1, 3, 1>(x, y));
+	_mm_store_ps(inv.M[1], Shuffle<2, 0, 2, 0>(x, y));
+	_mm_store_ps(inv.M[2], Shuffle<3, 1, 3, 1>(z, w));
+	_mm_store_ps(inv.M[3], Shuffle<2, 0, 2, 0>(z, w));
+	return inv;
+}
+
+#endif
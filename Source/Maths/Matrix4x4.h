@@ -4,15 +4,21 @@
 #include "Vec3.h"
 #include "Vec4.h"
 #include "Assert.h"
+#include "CpuFeatures.h"
 #include <numbers>
 
+#if TV_SIMD_X86
+#include <emmintrin.h>
+#endif
+
 namespace TV
 {
 	namespace Maths
 	{
-		// Matrix uses column major convention
+		// Matrix uses column major convention.
+		// Rows are aligned like TVec4 so each can be loaded into a simd register directly
 		template<class T>
-		class TMatrix4x4
+		class alignas(sizeof(T) * 4) TMatrix4x4
 		{
 		public:
 			union
@@ -71,11 +77,11 @@ namespace TV
 			[[nodiscard]] TVec3<T> TransformVector(const TVec3<T>& vector) const;
 			[[nodiscard]] TVec3<T> TransformPosition(const TVec3<T>& vector) const;
 
-			static [[nodiscard]] TMatrix4x4<T> MakeScale(const TVec3<T>& scale);
-			static [[nodiscard]] TMatrix4x4<T> MakeTranslation(const TVec3<T>& translation);
-			static [[nodiscard]] TMatrix4x4<T> MakePerspectiveProjection(T verticalFieldOfViewRadians, T aspectRatio, T nearClip, T farClip);
-			static [[nodiscard]] TMatrix4x4<T> MakeOrthographicProjection(T orthographicWidth, T aspectRatio, T nearClip, T farClip);
-			static [[nodiscard]] TMatrix4x4<T> MakeLookAt(const TVec3<T>& lookOrigin, const TVec3<T>& lookTarget, const TVec3<T>& upVector);
+			[[nodiscard]] static TMatrix4x4<T> MakeScale(const TVec3<T>& scale);
+			[[nodiscard]] static TMatrix4x4<T> MakeTranslation(const TVec3<T>& translation);
+			[[nodiscard]] static TMatrix4x4<T> MakePerspectiveProjection(T verticalFieldOfViewRadians, T aspectRatio, T nearClip, T farClip);
+			[[nodiscard]] static TMatrix4x4<T> MakeOrthographicProjection(T orthographicWidth, T aspectRatio, T nearClip, T farClip);
+			[[nodiscard]] static TMatrix4x4<T> MakeLookAt(const TVec3<T>& lookOrigin, const TVec3<T>& lookTarget, const TVec3<T>& upVector);
 		};
 
 		template<class T>
@@ -204,6 +210,7 @@ namespace TV
 					transposed.M[i][j] = M[j][i];
 				}
 			}
+			return transposed;
 		}
 
 		template<class T>
@@ -391,7 +398,7 @@ namespace TV
 		}
 
 		template<class T>
-		inline [[nodiscard]] TV::Maths::TMatrix4x4<T> operator * (const TV::Maths::TMatrix4x4<T>& a, const TV::Maths::TMatrix4x4<T>& b)
+		[[nodiscard]] inline TV::Maths::TMatrix4x4<T> operator * (const TV::Maths::TMatrix4x4<T>& a, const TV::Maths::TMatrix4x4<T>& b)
 		{
 			TMatrix4x4<T> result;
 			for (int32 i = 0; i != 4; ++i)
@@ -407,6 +414,68 @@ namespace TV
 			}
 			return result;
 		}
+
+#if TV_SIMD_X86
+		// Float specializations using sse2, which is part of the x86 baseline so needs no runtime dispatch.
+		// Products are summed in the same order as the generic versions, so results are identical apart from GetInverse
+
+		template<>
+		inline TV::Maths::TVec4<float> TV::Maths::TMatrix4x4<float>::TransformVector4(const TVec4<float>& vector) const
+		{
+			// the vector has usually just been written a component at a time, so a single load would stall waiting on the stores
+			const __m128 v = _mm_setr_ps(vector.X, vector.Y, vector.Z, vector.W);
+			__m128 term0 = _mm_mul_ps(_mm_load_ps(M[0]), v);
+			__m128 term1 = _mm_mul_ps(_mm_load_ps(M[1]), v);
+			__m128 term2 = _mm_mul_ps(_mm_load_ps(M[2]), v);
+			__m128 term3 = _mm_mul_ps(_mm_load_ps(M[3]), v);
+
+			// each row's products are across the lanes of one register, transposing lines them up to be summed
+			_MM_TRANSPOSE4_PS(term0, term1, term2, term3);
+
+			TVec4<float> ret;
+			_mm_store_ps(ret.Raw, _mm_add_ps(_mm_add_ps(_mm_add_ps(term0, term1), term2), term3));
+			return ret;
+		}
+
+		template<>
+		inline TV::Maths::TMatrix4x4<float> TV::Maths::TMatrix4x4<float>::GetTranspose() const
+		{
+			__m128 row0 = _mm_load_ps(M[0]);
+			__m128 row1 = _mm_load_ps(M[1]);
+			__m128 row2 = _mm_load_ps(M[2]);
+			__m128 row3 = _mm_load_ps(M[3]);
+			_MM_TRANSPOSE4_PS(row0, row1, row2, row3);
+
+			TMatrix4x4<float> transposed;
+			_mm_store_ps(transposed.M[0], row0);
+			_mm_store_ps(transposed.M[1], row1);
+			_mm_store_ps(transposed.M[2], row2);
+			_mm_store_ps(transposed.M[3], row3);
+			return transposed;
+		}
+
+		// block matrix method, defined in Matrix4x4.cpp
+		template<>
+		TV::Maths::TMatrix4x4<float> TV::Maths::TMatrix4x4<float>::GetInverse() const;
+
+		template<>
+		inline TV::Maths::TMatrix4x4<float> operator * (const TV::Maths::TMatrix4x4<float>& a, const TV::Maths::TMatrix4x4<float>& b)
+		{
+			const __m128 bRows[4] = { _mm_load_ps(b.M[0]), _mm_load_ps(b.M[1]), _mm_load_ps(b.M[2]), _mm_load_ps(b.M[3]) };
+
+			// each row of the result is a weighted sum of the rows of b
+			TMatrix4x4<float> result;
+			for (int32 i = 0; i != 4; ++i)
+			{
+				__m128 row = _mm_mul_ps(_mm_set1_ps(a.M[i][0]), bRows[0]);
+				row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(a.M[i][1]), bRows[1]));
+				row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(a.M[i][2]), bRows[2]));
+				row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(a.M[i][3]), bRows[3]));
+				_mm_store_ps(result.M[i], row);
+			}
+			return result;
+		}
+#endif
 	}
 }
 
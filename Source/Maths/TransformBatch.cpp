@@ -0,0 +1,367 @@
+#include "TransformBatch.h"
+
+#include <cmath>
+
+#if TV_SIMD_X86
+#include <immintrin.h>
+#endif
+
+namespace
+{
+	using namespace TV;
+	using namespace TV::Maths;
+
+	// elements [first, count) are always done here, so the simd versions only need to handle whole vectors
+	void TransformPositions_Scalar(const Matrix4x4f& matrix, const float* x, const float* y, const float* z, int32 first, int32 count, float* outX, float* outY, float* outZ, float* outW)
+	{
+		float* const outputs[4] = { outX, outY, outZ, outW };
+		for (int32 index = first; index < count; ++index)
+		{
+			for (int32 row = 0; row != 4; ++row)
+			{
+				outputs[row][index] = x[index] * matrix.M[row][0] + y[index] * matrix.M[row][1] + z[index] * matrix.M[row][2] + matrix.M[row][3];
+			}
+		}
+	}
+
+	void TransformVectors_Scalar(const Matrix4x4f& matrix, const float* x, const float* y, const float* z, int32 first, int32 count, float* outX, float* outY, float* outZ)
+	{
+		float* const outputs[3] = { outX, outY, outZ };
+		for (int32 index = first; index < count; ++index)
+		{
+			for (int32 row = 0; row != 3; ++row)
+			{
+				outputs[row][index] = x[index] * matrix.M[row][0] + y[index] * matrix.M[row][1] + z[index] * matrix.M[row][2];
+			}
+		}
+	}
+
+	void Normalize_Scalar(float* x, float* y, float* z, int32 first, int32 count)
+	{
+		for (int32 index = first; index < count; ++index)
+		{
+			const float length = std::sqrt(x[index] * x[index] + y[index] * y[index] + z[index] * z[index]);
+			const float scale = length < (float)C_KindaSmallNumber ? 0.f : 1.f / length;
+			x[index] *= scale;
+			y[index] *= scale;
+			z[index] *= scale;
+		}
+	}
+
+	void TransformVectors4_Scalar(const Matrix4x4f& matrix, const Vec4f* vectors, int32 first, int32 count, Vec4f* outVectors)
+	{
+		for (int32 index = first; index < count; ++index)
+		{
+			outVectors[index] = matrix.TransformVector4(vectors[index]);
+		}
+	}
+
+	void TransformPositionsAoS_Scalar(const Matrix4x4f& matrix, const Vec3f* positions, int32 first, int32 count, Vec4f* outPositions)
+	{
+		for (int32 index = first; index < count; ++index)
+		{
+			outPositions[index] = matrix.TransformVector4(Vec4f(positions[index], 1.f));
+		}
+	}
+
+#if TV_SIMD_X86
+	// column k holds M[0..3][k], so a vector's transform is the sum of the columns scaled by its components
+	TV_TARGET_SSE2 void LoadColumns(const Matrix4x4f& matrix, __m128 (&columns)[4])
+	{
+		columns[0] = _mm_load_ps(matrix.M[0]);
+		columns[1] = _mm_load_ps(matrix.M[1]);
+		columns[2] = _mm_load_ps(matrix.M[2]);
+		columns[3] = _mm_load_ps(matrix.M[3]);
+		_MM_TRANSPOSE4_PS(columns[0], columns[1], columns[2], columns[3]);
+	}
+
+	TV_TARGET_SSE2 int32 TransformVectors4_SSE2(const Matrix4x4f& matrix, const Vec4f* vectors, int32 count, Vec4f* outVectors)
+	{
+		__m128 columns[4];
+		LoadColumns(matrix, columns);
+
+		for (int32 index = 0; index != count; ++index)
+		{
+			const __m128 v = _mm_load_ps(vectors[index].Raw);
+			__m128 result = _mm_add_ps(_mm_mul_ps(columns[0], _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0))), _mm_mul_ps(columns[1], _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1))));
+			result = _mm_add_ps(result, _mm_mul_ps(columns[2], _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2))));
+			result = _mm_add_ps(result, _mm_mul_ps(columns[3], _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3))));
+			_mm_store_ps(outVectors[index].Raw, result);
+		}
+		return count;
+	}
+
+	// two vectors per register, one in each half
+	TV_TARGET_AVX2 int32 TransformVectors4_AVX2(const Matrix4x4f& matrix, const Vec4f* vectors, int32 count, Vec4f* outVectors)
+	{
+		__m128 columns[4];
+		LoadColumns(matrix, columns);
+		__m256 columns2[4];
+		for (int32 column = 0; column != 4; ++column)
+		{
+			columns2[column] = _mm256_insertf128_ps(_mm256_castps128_ps256(columns[column]), columns[column], 1);
+		}
+
+		int32 index = 0;
+		for (; index + 2 <= count; index += 2)
+		{
+			const __m256 v = _mm256_loadu_ps(vectors[index].Raw);
+			__m256 result = _mm256_add_ps(_mm256_mul_ps(columns2[0], _mm256_permute_ps(v, _MM_SHUFFLE(0, 0, 0, 0))), _mm256_mul_ps(columns2[1], _mm256_permute_ps(v, _MM_SHUFFLE(1, 1, 1, 1))));
+			result = _mm256_add_ps(result, _mm256_mul_ps(columns2[2], _mm256_permute_ps(v, _MM_SHUFFLE(2, 2, 2, 2))));
+			result = _mm256_add_ps(result, _mm256_mul_ps(columns2[3], _mm256_permute_ps(v, _MM_SHUFFLE(3, 3, 3, 3))));
+			_mm256_storeu_ps(outVectors[index].Raw, result);
+		}
+		return index;
+	}
+
+	TV_TARGET_SSE2 int32 TransformPositionsAoS_SSE2(const Matrix4x4f& matrix, const Vec3f* positions, int32 count, Vec4f* outPositions)
+	{
+		__m128 columns[4];
+		LoadColumns(matrix, columns);
+
+		for (int32 index = 0; index != count; ++index)
+		{
+			const Vec3f& position = positions[index];
+			__m128 result = _mm_add_ps(_mm_mul_ps(columns[0], _mm_set1_ps(position.X)), _mm_mul_ps(columns[1], _mm_set1_ps(position.Y)));
+			result = _mm_add_ps(result, _mm_mul_ps(columns[2], _mm_set1_ps(position.Z)));
+			result = _mm_add_ps(result, columns[3]);
+			_mm_store_ps(outPositions[index].Raw, result);
+		}
+		return count;
+	}
+
+	TV_TARGET_AVX2 int32 TransformPositionsAoS_AVX2(const Matrix4x4f& matrix, const Vec3f* positions, int32 count, Vec4f* outPositions)
+	{
+		__m128 columns[4];
+		LoadColumns(matrix, columns);
+		__m256 columns2[4];
+		for (int32 column = 0; column != 4; ++column)
+		{
+			columns2[column] = _mm256_insertf128_ps(_mm256_castps128_ps256(columns[column]), columns[column], 1);
+		}
+
+		int32 index = 0;
+		for (; index + 2 <= count; index += 2)
+		{
+			const Vec3f& a = positions[index];
+			const Vec3f& b = positions[index + 1];
+			__m256 result = _mm256_add_ps(_mm256_mul_ps(columns2[0], _mm256_setr_ps(a.X, a.X, a.X, a.X, b.X, b.X, b.X, b.X)), _mm256_mul_ps(columns2[1], _mm256_setr_ps(a.Y, a.Y, a.Y, a.Y, b.Y, b.Y, b.Y, b.Y)));
+			result = _mm256_add_ps(result, _mm256_mul_ps(columns2[2], _mm256_setr_ps(a.Z, a.Z, a.Z, a.Z, b.Z, b.Z, b.Z, b.Z)));
+			result = _mm256_add_ps(result, columns2[3]);
+			_mm256_storeu_ps(outPositions[index].Raw, result);
+		}
+		return index;
+	}
+
+	TV_TARGET_SSE2 int32 TransformPositions_SSE2(const Matrix4x4f& matrix, const float* x, const float* y, const float* z, int32 count, float* outX, float* outY, float* outZ, float* outW)
+	{
+		float* const outputs[4] = { outX, outY, outZ, outW };
+		int32 index = 0;
+		for (; index + 4 <= count; index += 4)
+		{
+			const __m128 vx = _mm_loadu_ps(x + index);
+			const __m128 vy = _mm_loadu_ps(y + index);
+			const __m128 vz = _mm_loadu_ps(z + index);
+			for (int32 row = 0; row != 4; ++row)
+			{
+				__m128 result = _mm_add_ps(_mm_mul_ps(vx, _mm_set1_ps(matrix.M[row][0])), _mm_mul_ps(vy, _mm_set1_ps(matrix.M[row][1])));
+				result = _mm_add_ps(result, _mm_mul_ps(vz, _mm_set1_ps(matrix.M[row][2])));
+				result = _mm_add_ps(result, _mm_set1_ps(matrix.M[row][3]));
+				_mm_storeu_ps(outputs[row] + index, result);
+			}
+		}
+		return index;
+	}
+
+	TV_TARGET_AVX2 int32 TransformPositions_AVX2(const Matrix4x4f& matrix, const float* x, const float* y, const float* z, int32 count, float* outX, float* outY, float* outZ, float* outW)
+	{
+		float* const outputs[4] = { outX, outY, outZ, outW };
+		int32 index = 0;
+		for (; index + 8 <= count; index += 8)
+		{
+			const __m256 vx = _mm256_loadu_ps(x + index);
+			const __m256 vy = _mm256_loadu_ps(y + index);
+			const __m256 vz = _mm256_loadu_ps(z + index);
+			for (int32 row = 0; row != 4; ++row)
+			{
+				__m256 result = _mm256_add_ps(_mm256_mul_ps(vx, _mm256_set1_ps(matrix.M[row][0])), _mm256_mul_ps(vy, _mm256_set1_ps(matrix.M[row][1])));
+				result = _mm256_add_ps(result, _mm256_mul_ps(vz, _mm256_set1_ps(matrix.M[row][2])));
+				result = _mm256_add_ps(result, _mm256_set1_ps(matrix.M[row][3]));
+				_mm256_storeu_ps(outputs[row] + index, result);
+			}
+		}
+		return index;
+	}
+
+	TV_TARGET_SSE2 int32 TransformVectors_SSE2(const Matrix4x4f& matrix, const float* x, const float* y, const float* z, int32 count, float* outX, float* outY, float* outZ)
+	{
+		float* const outputs[3] = { outX, outY, outZ };
+		int32 index = 0;
+		for (; index + 4 <= count; index += 4)
+		{
+			const __m128 vx = _mm_loadu_ps(x + index);
+			const __m128 vy = _mm_loadu_ps(y + index);
+			const __m128 vz = _mm_loadu_ps(z + index);
+			for (int32 row = 0; row != 3; ++row)
+			{
+				__m128 result = _mm_add_ps(_mm_mul_ps(vx, _mm_set1_ps(matrix.M[row][0])), _mm_mul_ps(vy, _mm_set1_ps(matrix.M[row][1])));
+				result = _mm_add_ps(result, _mm_mul_ps(vz, _mm_set1_ps(matrix.M[row][2])));
+				_mm_storeu_ps(outputs[row] + index, result);
+			}
+		}
+		return index;
+	}
+
+	TV_TARGET_AVX2 int32 TransformVectors_AVX2(const Matrix4x4f& matrix, const float* x, const float* y, const float* z, int32 count, float* outX, float* outY, float* outZ)
+	{
+		float* const outputs[3] = { outX, outY, outZ };
+		int32 index = 0;
+		for (; index + 8 <= count; index += 8)
+		{
+			const __m256 vx = _mm256_loadu_ps(x + index);
+			const __m256 vy = _mm256_loadu_ps(y + index);
+			const __m256 vz = _mm256_loadu_ps(z + index);
+			for (int32 row = 0; row != 3; ++row)
+			{
+				__m256 result = _mm256_add_ps(_mm256_mul_ps(vx, _mm256_set1_ps(matrix.M[row][0])), _mm256_mul_ps(vy, _mm256_set1_ps(matrix.M[row][1])));
+				result = _mm256_add_ps(result, _mm256_mul_ps(vz, _mm256_set1_ps(matrix.M[row][2])));
+				_mm256_storeu_ps(outputs[row] + index, result);
+			}
+		}
+		return index;
+	}
+
+	TV_TARGET_SSE2 int32 Normalize_SSE2(float* x, float* y, float* z, int32 count)
+	{
+		const __m128 minLength = _mm_set1_ps((float)C_KindaSmallNumber);
+		const __m128 one = _mm_set1_ps(1.f);
+		int32 index = 0;
+		for (; index + 4 <= count; index += 4)
+		{
+			const __m128 vx = _mm_loadu_ps(x + index);
+			const __m128 vy = _mm_loadu_ps(y + index);
+			const __m128 vz = _mm_loadu_ps(z + index);
+			const __m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, vx), _mm_mul_ps(vy, vy)), _mm_mul_ps(vz, vz)));
+			const __m128 scale = _mm_andnot_ps(_mm_cmplt_ps(length, minLength), _mm_div_ps(one, length));
+			_mm_storeu_ps(x + index, _mm_mul_ps(vx, scale));
+			_mm_storeu_ps(y + index, _mm_mul_ps(vy, scale));
+			_mm_storeu_ps(z + index, _mm_mul_ps(vz, scale));
+		}
+		return index;
+	}
+
+	TV_TARGET_AVX2 int32 Normalize_AVX2(float* x, float* y, float* z, int32 count)
+	{
+		const __m256 minLength = _mm256_set1_ps((float)C_KindaSmallNumber);
+		const __m256 one = _mm256_set1_ps(1.f);
+		int32 index = 0;
+		for (; index + 8 <= count; index += 8)
+		{
+			const __m256 vx = _mm256_loadu_ps(x + index);
+			const __m256 vy = _mm256_loadu_ps(y + index);
+			const __m256 vz = _mm256_loadu_ps(z + index);
+			const __m256 length = _mm256_sqrt_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(vx, vx), _mm256_mul_ps(vy, vy)), _mm256_mul_ps(vz, vz)));
+			const __m256 scale = _mm256_andnot_ps(_mm256_cmp_ps(length, minLength, _CMP_LT_OQ), _mm256_div_ps(one, length));
+			_mm256_storeu_ps(x + index, _mm256_mul_ps(vx, scale));
+			_mm256_storeu_ps(y + index, _mm256_mul_ps(vy, scale));
+			_mm256_storeu_ps(z + index, _mm256_mul_ps(vz, scale));
+		}
+		return index;
+	}
+#endif
+}
+
+void TV::Maths::TransformPositionsSoA(const Matrix4x4f& matrix, const float* x, const float* y, const float* z, int32 count, float* outX, float* outY, float* outZ, float* outW, SimdLevel simdLevel)
+{
+	int32 first = 0;
+#if TV_SIMD_X86
+	switch (GetSupportedSimdLevel(simdLevel))
+	{
+	case SimdLevel::AVX2:
+		first = TransformPositions_AVX2(matrix, x, y, z, count, outX, outY, outZ, outW);
+		break;
+	case SimdLevel::SSE2:
+		first = TransformPositions_SSE2(matrix, x, y, z, count, outX, outY, outZ, outW);
+		break;
+	default:
+		break;
+	}
+#endif
+	TransformPositions_Scalar(matrix, x, y, z, first, count, outX, outY, outZ, outW);
+}
+
+void TV::Maths::TransformVectorsSoA(const Matrix4x4f& matrix, const float* x, const float* y, const float* z, int32 count, float* outX, float* outY, float* outZ, SimdLevel simdLevel)
+{
+	int32 first = 0;
+#if TV_SIMD_X86
+	switch (GetSupportedSimdLevel(simdLevel))
+	{
+	case SimdLevel::AVX2:
+		first = TransformVectors_AVX2(matrix, x, y, z, count, outX, outY, outZ);
+		break;
+	case SimdLevel::SSE2:
+		first = TransformVectors_SSE2(matrix, x, y, z, count, outX, outY, outZ);
+		break;
+	default:
+		break;
+	}
+#endif
+	TransformVectors_Scalar(matrix, x, y, z, first, count, outX, outY, outZ);
+}
+
+void TV::Maths::NormalizeSoA(float* x, float* y, float* z, int32 count, SimdLevel simdLevel)
+{
+	int32 first = 0;
+#if TV_SIMD_X86
+	switch (GetSupportedSimdLevel(simdLevel))
+	{
+	case SimdLevel::AVX2:
+		first = Normalize_AVX2(x, y, z, count);
+		break;
+	case SimdLevel::SSE2:
+		first = Normalize_SSE2(x, y, z, count);
+		break;
+	default:
+		break;
+	}
+#endif
+	Normalize_Scalar(x, y, z, first, count);
+}
+
+void TV::Maths::TransformVectors4(const Matrix4x4f& matrix, const Vec4f* vectors, int32 count, Vec4f* outVectors, SimdLevel simdLevel)
+{
+	int32 first = 0;
+#if TV_SIMD_X86
+	switch (GetSupportedSimdLevel(simdLevel))
+	{
+	case SimdLevel::AVX2:
+		first = TransformVectors4_AVX2(matrix, vectors, count, outVectors);
+		break;
+	case SimdLevel::SSE2:
+		first = TransformVectors4_SSE2(matrix, vectors, count, outVectors);
+		break;
+	default:
+		break;
+	}
+#endif
+	TransformVectors4_Scalar(matrix, vectors, first, count, outVectors);
+}
+
+void TV::Maths::TransformPositions(const Matrix4x4f& matrix, const Vec3f* positions, int32 count, Vec4f* outPositions, SimdLevel simdLevel)
+{
+	int32 first = 0;
+#if TV_SIMD_X86
+	switch (GetSupportedSimdLevel(simdLevel))
+	{
+	case SimdLevel::AVX2:
+		first = TransformPositionsAoS_AVX2(matrix, positions, count, outPositions);
+		break;
+	case SimdLevel::SSE2:
+		first = TransformPositionsAoS_SSE2(matrix, positions, count, outPositions);
+		break;
+	default:
+		break;
+	}
+#endif
+	TransformPositionsAoS_Scalar(matrix, positions, first, count, outPositions);
+}
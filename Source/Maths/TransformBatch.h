@@ -0,0 +1,33 @@
+#pragma once
+
+#include "Types.h"
+#include "Vec3.h"
+#include "Vec4.h"
+#include "Matrix4x4.h"
+#include "CpuFeatures.h"
+
+namespace TV
+{
+	namespace Maths
+	{
+		// Transforms on structure of arrays data, where each component is a separate stream of count floats.
+		// These process 4 or 8 elements per instruction using the best level supported by the cpu up to simdLevel,
+		// and give the same results as the scalar Matrix4x4 transforms
+
+		// w is taken as 1
+		void TransformPositionsSoA(const Matrix4x4f& matrix, const float* x, const float* y, const float* z, int32 count, float* outX, float* outY, float* outZ, float* outW, SimdLevel simdLevel = SimdLevel::AVX2);
+
+		// w is taken as 0, so translation and projection are ignored
+		void TransformVectorsSoA(const Matrix4x4f& matrix, const float* x, const float* y, const float* z, int32 count, float* outX, float* outY, float* outZ, SimdLevel simdLevel = SimdLevel::AVX2);
+
+		// normalises in place, vectors too short to normalise become zero as with Vec3::GetSafeNormal
+		void NormalizeSoA(float* x, float* y, float* z, int32 count, SimdLevel simdLevel = SimdLevel::AVX2);
+
+		// Array of structures versions, for data which isn't split into streams. These also match Matrix4x4::TransformVector4
+
+		void TransformVectors4(const Matrix4x4f& matrix, const Vec4f* vectors, int32 count, Vec4f* outVectors, SimdLevel simdLevel = SimdLevel::AVX2);
+
+		// w is taken as 1 and the result isn't projected, so a projection matrix gives clip space positions
+		void TransformPositions(const Matrix4x4f& matrix, const Vec3f* positions, int32 count, Vec4f* outPositions, SimdLevel simdLevel = SimdLevel::AVX2);
+	}
+}
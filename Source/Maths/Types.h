@@ -5,9 +5,15 @@ namespace TV
 	using int8 = char;
 	using uint8 = unsigned char;
 
+	using int16 = short;
+	using uint16 = unsigned short;
+
 	using int32 = int;
 	using uint32 = unsigned int;
 
+	using int64 = long long;
+	using uint64 = unsigned long long;
+
 	constexpr double C_SmallNumber = 1e-8;
 	constexpr double C_KindaSmallNumber = 1e-4;
 }
\ No newline at end of file
@@ -66,7 +66,7 @@ namespace TV
 		};
 
 		template<class T, class U>
-		inline [[nodiscard]] TVec2<T> GetLerp(const TVec2<T>& a, const TVec2<T>& b, U alpha)
+		[[nodiscard]] inline TVec2<T> GetLerp(const TVec2<T>& a, const TVec2<T>& b, U alpha)
 		{
 			TVec2<T> vec;
 			vec.X = GetLerp(a.X, b.X, alpha);
@@ -75,19 +75,19 @@ namespace TV
 		}
 
 		template<class T>
-		inline [[nodiscard]] TVec2<T> operator + (const TVec2<T>& a, const TVec2<T>& b)
+		[[nodiscard]] inline TVec2<T> operator + (const TVec2<T>& a, const TVec2<T>& b)
 		{
 			return TVec2<T>(a.X + b.X, a.Y + b.Y);
 		}
 
 		template<class T>
-		inline [[nodiscard]] TVec2<T> operator - (const TVec2<T>& a, const TVec2<T>& b)
+		[[nodiscard]] inline TVec2<T> operator - (const TVec2<T>& a, const TVec2<T>& b)
 		{
 			return TVec2<T>(a.X - b.X, a.Y - b.Y);
 		}
 
 		template<class T>
-		inline [[nodiscard]] TVec2<T> operator * (const TVec2<T>& vector, float factor)
+		[[nodiscard]] inline TVec2<T> operator * (const TVec2<T>& vector, float factor)
 		{
 			TVec2<T> vec(vector);
 			vec *= factor;
@@ -95,7 +95,7 @@ namespace TV
 		}
 
 		template<class T>
-		inline [[nodiscard]] TVec2<T> operator * (const TVec2<T>& vector, const TVec2<T>& factor)
+		[[nodiscard]] inline TVec2<T> operator * (const TVec2<T>& vector, const TVec2<T>& factor)
 		{
 			TVec2<T> vec(vector);
 			vec *= factor;
@@ -103,21 +103,28 @@ namespace TV
 		}
 
 		template<class T>
-		inline [[nodiscard]] double GetDotProduct(const TVec2<T>& a, const TVec2<T>& b)
+		[[nodiscard]] inline double GetDotProduct(const TVec2<T>& a, const TVec2<T>& b)
 		{
 			return (a.X * b.X) + (a.Y * b.Y);
 		}
 
+		// z component of the 3D cross product, positive if b is counter clockwise from a
+		template<class T>
+		[[nodiscard]] inline T GetCrossProduct(const TVec2<T>& a, const TVec2<T>& b)
+		{
+			return (a.X * b.Y) - (a.Y * b.X);
+		}
+
 		using Vec2i = TVec2<int32>;
 		using Vec2f = TVec2<float>;
 		using Vec2d = TVec2<double>;
 
-		inline [[nodiscard]] Vec2f ToFloat(const Vec2i& vec)
+		[[nodiscard]] inline Vec2f ToFloat(const Vec2i& vec)
 		{
 			return Vec2f((float)vec.X, (float)vec.Y);
 		}
 
-		inline [[nodiscard]] Vec2i GetRoundToInt(const Vec2f& vec)
+		[[nodiscard]] inline Vec2i GetRoundToInt(const Vec2f& vec)
 		{
 			return Vec2i(GetRoundToInt(vec.X), GetRoundToInt(vec.Y));
 		}
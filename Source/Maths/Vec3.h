@@ -107,22 +107,22 @@ namespace TV
 		};
 
 		template<class T>
-		__declspec(selectany) const TVec3<T> TV::Maths::TVec3<T>::UpVector(0, 1, 0);
+		const TVec3<T> TV::Maths::TVec3<T>::UpVector(0, 1, 0);
 
 		template<class T>
-		inline [[nodiscard]] TVec3<T> GetMin(const TVec3<T>& a, const TVec3<T>& b)
+		[[nodiscard]] inline TVec3<T> GetMin(const TVec3<T>& a, const TVec3<T>& b)
 		{
 			return TVec3<T>(GetMin(a.X, b.X), GetMin(a.Y, b.Y), GetMin(a.Z, b.Z));
 		}
 
 		template<class T>
-		inline [[nodiscard]] TVec3<T> GetMax(const TVec3<T>& a, const TVec3<T>& b)
+		[[nodiscard]] inline TVec3<T> GetMax(const TVec3<T>& a, const TVec3<T>& b)
 		{
 			return TVec3<T>(GetMax(a.X, b.X), GetMax(a.Y, b.Y), GetMax(a.Z, b.Z));
 		}
 
 		template<class T, class U>
-		inline [[nodiscard]] TVec3<T> GetLerp(const TVec3<T>& a, const TVec3<T>& b, U alpha)
+		[[nodiscard]] inline TVec3<T> GetLerp(const TVec3<T>& a, const TVec3<T>& b, U alpha)
 		{
 			TVec3<T> vec;
 			vec.X = Lerp(a.X, b.X, alpha);
@@ -132,19 +132,19 @@ namespace TV
 		}
 
 		template<class T>
-		inline [[nodiscard]] TVec3<T> operator + (const TVec3<T>& a, const TVec3<T>& b)
+		[[nodiscard]] inline TVec3<T> operator + (const TVec3<T>& a, const TVec3<T>& b)
 		{
 			return TVec3<T>(a.X + b.X, a.Y + b.Y, a.Z + b.Z);
 		}
 
 		template<class T>
-		inline [[nodiscard]] TVec3<T> operator - (const TVec3<T>& a, const TVec3<T>& b)
+		[[nodiscard]] inline TVec3<T> operator - (const TVec3<T>& a, const TVec3<T>& b)
 		{
 			return TVec3<T>(a.X - b.X, a.Y - b.Y, a.Z - b.Z);
 		}
 
 		template<class T>
-		inline [[nodiscard]] TVec3<T> operator * (const TVec3<T>& vector, T factor)
+		[[nodiscard]] inline TVec3<T> operator * (const TVec3<T>& vector, T factor)
 		{
 			TVec3<T> vec(vector);
 			vec *= factor;
@@ -152,7 +152,7 @@ namespace TV
 		}
 
 		template<class T>
-		inline [[nodiscard]] TVec3<T> operator / (const TVec3<T>& vector, T divisor)
+		[[nodiscard]] inline TVec3<T> operator / (const TVec3<T>& vector, T divisor)
 		{
 			TVec3<T> vec(vector);
 			vec /= divisor;
@@ -160,13 +160,13 @@ namespace TV
 		}
 
 		template<class T>
-		inline [[nodiscard]] double GetDotProduct(const TVec3<T>& a, const TVec3<T>& b)
+		[[nodiscard]] inline double GetDotProduct(const TVec3<T>& a, const TVec3<T>& b)
 		{
 			return (a.X * b.X) + (a.Y * b.Y) + (a.Z * b.Z);
 		}
 
 		template<class T>
-		inline [[nodiscard]] TVec3<T> GetCrossProduct(const TVec3<T>& a, const TVec3<T>& b)
+		[[nodiscard]] inline TVec3<T> GetCrossProduct(const TVec3<T>& a, const TVec3<T>& b)
 		{
 			return TVec3<T>(
 				a.Y * b.Z - a.Z * b.Y,
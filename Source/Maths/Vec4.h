@@ -6,8 +6,9 @@ namespace TV
 {
 	namespace Maths
 	{
+		// aligned to its size so it can be loaded into a simd register directly
 		template<class T>
-		class TVec4
+		class alignas(sizeof(T) * 4) TVec4
 		{
 		public:
 			union
@@ -65,7 +66,7 @@ namespace TV
 		};
 
 		template<class T>
-		inline [[nodiscard]] TVec4<T> operator * (const TVec4<T>& vector, T factor)
+		[[nodiscard]] inline TVec4<T> operator * (const TVec4<T>& vector, T factor)
 		{
 			TVec4<T> vec(vector);
 			vec *= factor;
@@ -0,0 +1,119 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+bool TV::Renderer::MappedFile::Open(const char* fileName)
+{
+	Close();
+
+#ifdef _WIN32
+	HANDLE file = CreateFileA(fileName, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize))
+	{
+		CloseHandle(file);
+		return false;
+	}
+	if (fileSize.QuadPart == 0)
+	{
+		CloseHandle(file);
+		bOpenEmpty = true;
+		return true;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mapping == nullptr)
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (view == nullptr)
+	{
+		CloseHandle(mapping);
+		CloseHandle(file);
+		return false;
+	}
+
+	FileHandle = file;
+	MappingHandle = mapping;
+	Data = (const char*)view;
+	Size = (size_t)fileSize.QuadPart;
+#else
+	const int file = open(fileName, O_RDONLY);
+	if (file < 0)
+	{
+		return false;
+	}
+
+	struct stat fileStat;
+	if (fstat(file, &fileStat) != 0)
+	{
+		close(file);
+		return false;
+	}
+	if (fileStat.st_size == 0)
+	{
+		close(file);
+		bOpenEmpty = true;
+		return true;
+	}
+
+	void* view = mmap(nullptr, (size_t)fileStat.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+	// the mapping keeps its own reference to the file
+	close(file);
+	if (view == MAP_FAILED)
+	{
+		return false;
+	}
+	madvise(view, (size_t)fileStat.st_size, MADV_SEQUENTIAL);
+
+	Data = (const char*)view;
+	Size = (size_t)fileStat.st_size;
+#endif
+
+	return true;
+}
+
+void TV::Renderer::MappedFile::Close()
+{
+#ifdef _WIN32
+	if (Data != nullptr)
+	{
+		UnmapViewOfFile(Data);
+	}
+	if (MappingHandle != nullptr)
+	{
+		CloseHandle(MappingHandle);
+	}
+	if (FileHandle != nullptr)
+	{
+		CloseHandle(FileHandle);
+	}
+	FileHandle = nullptr;
+	MappingHandle = nullptr;
+#else
+	if (Data != nullptr)
+	{
+		munmap((void*)Data, Size);
+	}
+#endif
+
+	Data = nullptr;
+	Size = 0;
+	bOpenEmpty = false;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "../Maths/Types.h"
+
+#include <cstddef>
+
+namespace TV
+{
+	namespace Renderer
+	{
+		// Read only view of a whole file mapped into memory
+		class MappedFile
+		{
+		public:
+			MappedFile() {}
+			~MappedFile() { Close(); }
+
+			MappedFile(const MappedFile&) = delete;
+			MappedFile& operator = (const MappedFile&) = delete;
+
+			bool Open(const char* fileName);
+			void Close();
+
+			bool IsOpen() const { return Data != nullptr || bOpenEmpty; }
+			const char* GetData() const { return Data; }
+			size_t GetSize() const { return Size; }
+
+		private:
+			const char* Data = nullptr;
+			size_t Size = 0;
+			bool bOpenEmpty = false; // empty files can't be mapped, but still open successfully
+
+#ifdef _WIN32
+			void* FileHandle = nullptr;
+			void* MappingHandle = nullptr;
+#endif
+		};
+	}
+}
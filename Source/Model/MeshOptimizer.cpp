@@ -0,0 +1,315 @@
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <climits>
+#include <numeric>
+
+namespace
+{
+	using namespace TV;
+	using namespace TV::Maths;
+	using namespace TV::Renderer;
+
+	// FIFO cache where a vertex is resident if fewer than cacheSize misses have happened since it was loaded
+	class VertexCacheSimulation
+	{
+	public:
+		VertexCacheSimulation(int32 numVertices, int32 cacheSize) : LoadTimes(numVertices, INT_MIN / 2), CacheSize(cacheSize) {}
+
+		void Reset()
+		{
+			// pretend everything was loaded long enough ago to have been evicted
+			Misses += CacheSize;
+		}
+
+		// returns the number of misses for the triangle
+		int32 AddTriangle(const Model::Tri& tri)
+		{
+			int32 triangleMisses = 0;
+			for (const int32 vertexIndex : tri.VertexIndex)
+			{
+				if (Misses - LoadTimes[vertexIndex] >= CacheSize)
+				{
+					LoadTimes[vertexIndex] = Misses++;
+					++triangleMisses;
+				}
+			}
+			return triangleMisses;
+		}
+
+	private:
+		std::vector<int32> LoadTimes;
+		int32 CacheSize;
+		int32 Misses = 0;
+	};
+
+	// triangles using each vertex, as offsets into a single array
+	struct VertexAdjacency
+	{
+		std::vector<int32> Offsets;
+		std::vector<int32> Triangles;
+
+		VertexAdjacency(const std::vector<Model::Tri>& tris, int32 numVertices) : Offsets(numVertices + 1, 0), Triangles(tris.size() * 3)
+		{
+			for (const Model::Tri& tri : tris)
+			{
+				for (const int32 vertexIndex : tri.VertexIndex)
+				{
+					++Offsets[vertexIndex + 1];
+				}
+			}
+			std::partial_sum(Offsets.begin(), Offsets.end(), Offsets.begin());
+
+			std::vector<int32> fill(Offsets.begin(), Offsets.end() - 1);
+			for (int32 triIndex = 0; triIndex != (int32)tris.size(); ++triIndex)
+			{
+				for (const int32 vertexIndex : tris[triIndex].VertexIndex)
+				{
+					Triangles[fill[vertexIndex]++] = triIndex;
+				}
+			}
+		}
+	};
+
+	Vec3f GetTriangleCentroid(const Model::Tri& tri, const std::vector<Vertex>& vertices)
+	{
+		return (vertices[tri.VertexIndex[0]].Position + vertices[tri.VertexIndex[1]].Position + vertices[tri.VertexIndex[2]].Position) / 3.f;
+	}
+
+	// area weighted
+	Vec3f GetTriangleNormal(const Model::Tri& tri, const std::vector<Vertex>& vertices)
+	{
+		const Vec3f& a = vertices[tri.VertexIndex[0]].Position;
+		return GetCrossProduct(vertices[tri.VertexIndex[1]].Position - a, vertices[tri.VertexIndex[2]].Position - a);
+	}
+}
+
+float TV::Renderer::ComputeACMR(const std::vector<Model::Tri>& tris, int32 numVertices, int32 cacheSize)
+{
+	if (tris.empty())
+	{
+		return 0.f;
+	}
+
+	VertexCacheSimulation cache(numVertices, cacheSize);
+	int64 misses = 0;
+	for (const Model::Tri& tri : tris)
+	{
+		misses += cache.AddTriangle(tri);
+	}
+	return (float)((double)misses / (double)tris.size());
+}
+
+void TV::Renderer::OptimizeVertexCache(std::vector<Model::Tri>& tris, int32 numVertices, int32 cacheSize, std::vector<int32>* clusterStarts)
+{
+	const VertexAdjacency adjacency(tris, numVertices);
+
+	std::vector<int32> liveTriangles(numVertices);
+	for (int32 vertexIndex = 0; vertexIndex != numVertices; ++vertexIndex)
+	{
+		liveTriangles[vertexIndex] = adjacency.Offsets[vertexIndex + 1] - adjacency.Offsets[vertexIndex];
+	}
+
+	std::vector<int32> cacheTimes(numVertices, 0);
+	std::vector<bool> emitted(tris.size(), false);
+	std::vector<int32> deadEndStack;
+	std::vector<int32> candidates;
+	std::vector<Model::Tri> output;
+	output.reserve(tris.size());
+	if (clusterStarts != nullptr)
+	{
+		clusterStarts->clear();
+	}
+
+	int32 timeStamp = cacheSize + 1;
+	int32 nextUnvisited = 0;
+
+	// once the neighbourhood is used up continue from the most recently used vertex which still has triangles, or failing that anywhere
+	const auto skipDeadEnd = [&]() -> int32
+	{
+		while (!deadEndStack.empty())
+		{
+			const int32 vertexIndex = deadEndStack.back();
+			deadEndStack.pop_back();
+			if (liveTriangles[vertexIndex] > 0)
+			{
+				return vertexIndex;
+			}
+		}
+		for (; nextUnvisited < numVertices; ++nextUnvisited)
+		{
+			if (liveTriangles[nextUnvisited] > 0)
+			{
+				return nextUnvisited;
+			}
+		}
+		return -1;
+	};
+
+	int32 fanningVertex = skipDeadEnd();
+	bool bNewCluster = true;
+	while (fanningVertex >= 0)
+	{
+		if (bNewCluster && clusterStarts != nullptr)
+		{
+			clusterStarts->push_back((int32)output.size());
+		}
+
+		// emit every remaining triangle around the fanning vertex
+		candidates.clear();
+		for (int32 offset = adjacency.Offsets[fanningVertex]; offset != adjacency.Offsets[fanningVertex + 1]; ++offset)
+		{
+			const int32 triIndex = adjacency.Triangles[offset];
+			if (emitted[triIndex])
+			{
+				continue;
+			}
+			emitted[triIndex] = true;
+			output.push_back(tris[triIndex]);
+
+			for (const int32 vertexIndex : tris[triIndex].VertexIndex)
+			{
+				deadEndStack.push_back(vertexIndex);
+				candidates.push_back(vertexIndex);
+				--liveTriangles[vertexIndex];
+				if (timeStamp - cacheTimes[vertexIndex] > cacheSize)
+				{
+					cacheTimes[vertexIndex] = timeStamp++;
+				}
+			}
+		}
+
+		// next fan around the candidate which will still be in the cache after its remaining triangles are emitted,
+		// preferring those which entered the cache earliest
+		int32 bestVertex = -1;
+		int32 bestPriority = -1;
+		for (const int32 vertexIndex : candidates)
+		{
+			if (liveTriangles[vertexIndex] > 0)
+			{
+				int32 priority = 0;
+				if (timeStamp - cacheTimes[vertexIndex] + 2 * liveTriangles[vertexIndex] <= cacheSize)
+				{
+					priority = timeStamp - cacheTimes[vertexIndex];
+				}
+				if (priority > bestPriority)
+				{
+					bestPriority = priority;
+					bestVertex = vertexIndex;
+				}
+			}
+		}
+
+		bNewCluster = bestVertex < 0;
+		fanningVertex = bNewCluster ? skipDeadEnd() : bestVertex;
+	}
+
+	tris.swap(output);
+}
+
+void TV::Renderer::OptimizeOverdraw(std::vector<Model::Tri>& tris, const std::vector<Vertex>& vertices, const std::vector<int32>& clusterStarts, int32 cacheSize, float threshold)
+{
+	if (tris.empty())
+	{
+		return;
+	}
+
+	// split clusters wherever the prefix since the last split has a hit rate close enough to the whole cluster's
+	std::vector<int32> splits;
+	VertexCacheSimulation cache((int32)vertices.size(), cacheSize);
+	for (int32 clusterIndex = 0; clusterIndex != (int32)clusterStarts.size(); ++clusterIndex)
+	{
+		const int32 clusterStart = clusterStarts[clusterIndex];
+		const int32 clusterEnd = clusterIndex + 1 != (int32)clusterStarts.size() ? clusterStarts[clusterIndex + 1] : (int32)tris.size();
+
+		cache.Reset();
+		int32 clusterMisses = 0;
+		for (int32 triIndex = clusterStart; triIndex != clusterEnd; ++triIndex)
+		{
+			clusterMisses += cache.AddTriangle(tris[triIndex]);
+		}
+		const float clusterACMR = clusterMisses / (float)(clusterEnd - clusterStart);
+
+		splits.push_back(clusterStart);
+		cache.Reset();
+		int32 splitStart = clusterStart;
+		int32 splitMisses = 0;
+		for (int32 triIndex = clusterStart; triIndex != clusterEnd; ++triIndex)
+		{
+			splitMisses += cache.AddTriangle(tris[triIndex]);
+			const int32 splitSize = triIndex + 1 - splitStart;
+			if (triIndex + 1 != clusterEnd && splitMisses <= threshold * clusterACMR * splitSize)
+			{
+				splits.push_back(triIndex + 1);
+				cache.Reset();
+				splitStart = triIndex + 1;
+				splitMisses = 0;
+			}
+		}
+	}
+
+	Vec3f meshCentroid;
+	for (const Model::Tri& tri : tris)
+	{
+		meshCentroid += GetTriangleCentroid(tri, vertices);
+	}
+	meshCentroid /= (float)tris.size();
+
+	struct Cluster
+	{
+		int32 Start;
+		int32 End;
+		float SortKey;
+	};
+	std::vector<Cluster> clusters;
+	clusters.reserve(splits.size());
+	for (int32 splitIndex = 0; splitIndex != (int32)splits.size(); ++splitIndex)
+	{
+		Cluster cluster;
+		cluster.Start = splits[splitIndex];
+		cluster.End = splitIndex + 1 != (int32)splits.size() ? splits[splitIndex + 1] : (int32)tris.size();
+
+		Vec3f centroid;
+		Vec3f normal;
+		for (int32 triIndex = cluster.Start; triIndex != cluster.End; ++triIndex)
+		{
+			centroid += GetTriangleCentroid(tris[triIndex], vertices);
+			normal += GetTriangleNormal(tris[triIndex], vertices);
+		}
+		centroid /= (float)(cluster.End - cluster.Start);
+
+		cluster.SortKey = (float)GetDotProduct(centroid - meshCentroid, normal.GetSafeNormal());
+		clusters.push_back(cluster);
+	}
+
+	std::stable_sort(clusters.begin(), clusters.end(), [](const Cluster& a, const Cluster& b) { return a.SortKey > b.SortKey; });
+
+	std::vector<Model::Tri> output;
+	output.reserve(tris.size());
+	for (const Cluster& cluster : clusters)
+	{
+		output.insert(output.end(), tris.begin() + cluster.Start, tris.begin() + cluster.End);
+	}
+	tris.swap(output);
+}
+
+void TV::Renderer::OptimizeVertexFetch(std::vector<Model::Tri>& tris, std::vector<Vertex>& vertices)
+{
+	std::vector<int32> remap(vertices.size(), -1);
+	std::vector<Vertex> output;
+	output.reserve(vertices.size());
+
+	for (Model::Tri& tri : tris)
+	{
+		for (int32& vertexIndex : tri.VertexIndex)
+		{
+			if (remap[vertexIndex] < 0)
+			{
+				remap[vertexIndex] = (int32)output.size();
+				output.push_back(vertices[vertexIndex]);
+			}
+			vertexIndex = remap[vertexIndex];
+		}
+	}
+	vertices.swap(output);
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "../Maths/Types.h"
+#include "../Renderer/Vertex.h"
+#include "Model.h"
+
+#include <vector>
+
+namespace TV
+{
+	namespace Renderer
+	{
+		using namespace Maths;
+
+		// Average cache misses per triangle for a FIFO post-transform cache of cacheSize vertices, between 0.5 and 3 for sensible meshes.
+		// Triangles with no shared vertices score 3, so lower is better
+		float ComputeACMR(const std::vector<Model::Tri>& tris, int32 numVertices, int32 cacheSize);
+
+		// Reorders triangles for vertex cache hit rate, using Tipsify
+		// http://gfx.cs.princeton.edu/pubs/Sander_2007_%3ETR/tipsy.pdf
+		// If clusterStarts is set it receives the indices of triangles which start a new run of triangles,
+		// the places where the ordering had to jump to an unconnected part of the mesh
+		void OptimizeVertexCache(std::vector<Model::Tri>& tris, int32 numVertices, int32 cacheSize, std::vector<int32>* clusterStarts = nullptr);
+
+		// Reorders the clusters of a cache optimized triangle order so those facing out from the middle of the mesh come first.
+		// They are the most likely to occlude others, so more is rejected by the depth test whichever way the mesh is viewed.
+		// Clusters are split further while the split costs less than threshold times their ACMR
+		void OptimizeOverdraw(std::vector<Model::Tri>& tris, const std::vector<Vertex>& vertices, const std::vector<int32>& clusterStarts, int32 cacheSize, float threshold);
+
+		// Reorders vertices to the order triangles first use them, so vertex fetches walk memory linearly. Unused vertices are removed
+		void OptimizeVertexFetch(std::vector<Model::Tri>& tris, std::vector<Vertex>& vertices);
+	}
+}
@@ -1,140 +1,436 @@
 #include "Model.h"
 
-#include <string>
+#include <cfloat>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
 #include <fstream>
-#include <sstream>
+#include <string>
+#include <thread>
 #include "../Maths/Assert.h"
+#include "../Maths/Hash.h"
+#include "MeshOptimizer.h"
+#include "../Renderer/ThreadPool.h"
 
 using namespace TV::Renderer;
 
-bool Model::LoadWavefrontFile(const char* FileName)
+namespace
 {
-	std::ifstream in;
-	in.open(FileName, std::ifstream::in);
-	if (in.fail())
-	{
-		return false;
-	}
-
-	std::vector<Vec3f> positions;
-	std::vector<Vec2f> texCoords;
-	std::vector<Vec3f> normals;
+	using namespace TV;
+	using namespace TV::Maths;
 
 	struct VertexRef
 	{
 		int32 PosIndex = 0;
 		int32 TexCoordIndex = 0;
 		int32 NormalIndex = 0;
-
-		bool operator == (const VertexRef& other) const
-		{
-			return PosIndex == other.PosIndex && TexCoordIndex == other.TexCoordIndex && NormalIndex == other.NormalIndex;
-		}
 	};
 	struct TriRef
 	{
 		VertexRef Vertices[3];
 	};
-	std::vector<TriRef> tris;
 
-	_Min = Vec3f(FLT_MAX);
-	_Max = Vec3f(FLT_MAX * -1.f);
+	// everything read from a range of whole lines of the file
+	struct ObjChunk
+	{
+		std::vector<Vec3f> Positions;
+		std::vector<Vec2f> TexCoords;
+		std::vector<Vec3f> Normals;
+		std::vector<TriRef> Tris;
+		bool bValid = true;
+	};
 
-	std::string line;
-	while (!in.eof())
+	// Reads tokens straight out of the file's memory, never allocates
+	class ObjTokenizer
 	{
-		std::getline(in, line);
-		std::istringstream iss(line.c_str());
-		char trash;
-		if (!line.compare(0, 2, "v "))
+	public:
+		ObjTokenizer(const char* begin, const char* end) : Current(begin), End(end) {}
+
+		bool IsAtEnd() const { return Current == End; }
+
+		void SkipSpaces()
 		{
-			// read a vector
-			iss >> trash;
-			Vec3f v;
-			for (int32 i = 0; i < 3; i++)
+			while (Current != End && (*Current == ' ' || *Current == '\t' || *Current == '\r'))
 			{
-				iss >> v.Raw[i];
+				++Current;
 			}
-			positions.push_back(v);
+		}
 
-			_Min = GetMin(_Min, v);
-			_Max = GetMax(_Max, v);
+		void SkipLine()
+		{
+			const char* newLine = (const char*)std::memchr(Current, '\n', End - Current);
+			Current = newLine != nullptr ? newLine + 1 : End;
 		}
-		else if (!line.compare(0, 3, "vt "))
+
+		// consumes the keyword if it is the next token
+		bool MatchKeyword(const char* keyword)
 		{
-			// read a tex coord
-			iss >> trash;
-			iss >> trash;
-			Vec2f texCoord;
-			for (int32 i = 0; i < 2; i++)
+			const size_t length = std::strlen(keyword);
+			if ((size_t)(End - Current) <= length || std::memcmp(Current, keyword, length) != 0)
+			{
+				return false;
+			}
+			const char next = Current[length];
+			if (next != ' ' && next != '\t')
 			{
-				iss >> texCoord.Raw[i];
+				return false;
 			}
-			texCoords.push_back(texCoord);
+			Current += length;
+			return true;
 		}
-		else if (!line.compare(0, 3, "vn "))
+
+		bool ReadFloat(float& value)
 		{
-			// read a normal
-			iss >> trash;
-			iss >> trash;
-			Vec3f normal;
-			for (int32 i = 0; i < 3; i++)
+			SkipSpaces();
+			if (Current != End && *Current == '+')
+			{
+				++Current;
+			}
+			const std::from_chars_result result = std::from_chars(Current, End, value);
+			if (result.ec == std::errc::invalid_argument)
 			{
-				iss >> normal.Raw[i];
+				return false;
 			}
-			normals.push_back(normal);
+			Current = result.ptr;
+			return true;
 		}
-		else if (!line.compare(0, 2, "f "))
+
+		bool ReadInt(int32& value)
 		{
-			// read a face
-			iss >> trash;
-			// format is e.g.
-			// f 288/270/288 412/402/412 479/470/479
-			TriRef tri;
-			for (int32 i = 0; i != 3; ++i)
+			SkipSpaces();
+			const std::from_chars_result result = std::from_chars(Current, End, value);
+			if (result.ec != std::errc())
 			{
-				iss >> tri.Vertices[i].PosIndex >> trash >> tri.Vertices[i].TexCoordIndex >> trash >> tri.Vertices[i].NormalIndex;
-				
-				// in wavefront obj all indices start at 1, not zero
-				--tri.Vertices[i].PosIndex;
-				--tri.Vertices[i].TexCoordIndex;
-				--tri.Vertices[i].NormalIndex;
+				return false;
 			}
-			tris.push_back(tri);
+			Current = result.ptr;
+			return true;
+		}
+
+		bool ReadChar(char c)
+		{
+			if (Current == End || *Current != c)
+			{
+				return false;
+			}
+			++Current;
+			return true;
+		}
+
+	private:
+		const char* Current;
+		const char* End;
+	};
+
+	void ParseObjLines(const char* begin, const char* end, ObjChunk& chunk)
+	{
+		ObjTokenizer tokens(begin, end);
+		while (chunk.bValid && !tokens.IsAtEnd())
+		{
+			tokens.SkipSpaces();
+			if (tokens.MatchKeyword("v"))
+			{
+				Vec3f position;
+				chunk.bValid = tokens.ReadFloat(position.X) && tokens.ReadFloat(position.Y) && tokens.ReadFloat(position.Z);
+				chunk.Positions.push_back(position);
+			}
+			else if (tokens.MatchKeyword("vt"))
+			{
+				Vec2f texCoord;
+				chunk.bValid = tokens.ReadFloat(texCoord.X) && tokens.ReadFloat(texCoord.Y);
+				chunk.TexCoords.push_back(texCoord);
+			}
+			else if (tokens.MatchKeyword("vn"))
+			{
+				Vec3f normal;
+				chunk.bValid = tokens.ReadFloat(normal.X) && tokens.ReadFloat(normal.Y) && tokens.ReadFloat(normal.Z);
+				chunk.Normals.push_back(normal);
+			}
+			else if (tokens.MatchKeyword("f"))
+			{
+				// format is e.g.
+				// f 288/270/288 412/402/412 479/470/479
+				TriRef tri;
+				for (VertexRef& vertRef : tri.Vertices)
+				{
+					chunk.bValid = chunk.bValid
+						&& tokens.ReadInt(vertRef.PosIndex) && tokens.ReadChar('/')
+						&& tokens.ReadInt(vertRef.TexCoordIndex) && tokens.ReadChar('/')
+						&& tokens.ReadInt(vertRef.NormalIndex);
+
+					// in wavefront obj all indices start at 1, not zero
+					--vertRef.PosIndex;
+					--vertRef.TexCoordIndex;
+					--vertRef.NormalIndex;
+				}
+				chunk.Tris.push_back(tri);
+			}
+			tokens.SkipLine();
 		}
 	}
 
-	// now convert to more standard format with vertex data grouped together
-	std::vector<VertexRef> uniqueVertices;
-	for (const TriRef& triRef : tris)
+	template<int32 N>
+	struct WeldKey
 	{
-		Tri tri;
+		int32 Values[N];
 
-		for (int32 triPointIndex = 0; triPointIndex != 3; ++triPointIndex)
+		bool operator == (const WeldKey& other) const
 		{
-			const VertexRef& vertRef = triRef.Vertices[triPointIndex];
+			return std::memcmp(Values, other.Values, sizeof(Values)) == 0;
+		}
 
-			// check if vertex already exists
-			int32 index = -1;
-			for (int32 existingIndex = 0; existingIndex != uniqueVertices.size(); ++existingIndex)
+		uint64 GetHash() const
+		{
+			uint64 hash = 0x9E3779B97F4A7C15ull;
+			for (const int32 value : Values)
 			{
-				if (uniqueVertices[existingIndex] == vertRef)
+				hash = (hash ^ (uint32)value) * 0xFF51AFD7ED558CCDull;
+				hash ^= hash >> 32;
+			}
+			return hash;
+		}
+	};
+
+	// Open addressing hash map from a vertex key to the index of the unique vertex, sized up front so it never grows
+	template<class TKey>
+	class VertexWeldMap
+	{
+	public:
+		explicit VertexWeldMap(size_t maxEntries)
+		{
+			// keep the load factor under a half so probe sequences stay short
+			size_t capacity = 16;
+			while (capacity < maxEntries * 2)
+			{
+				capacity <<= 1;
+			}
+			Keys.resize(capacity);
+			Indices.assign(capacity, -1);
+			Mask = capacity - 1;
+		}
+
+		// returns the index stored for an equal key, or stores newIndex if there isn't one
+		int32 FindOrAdd(const TKey& key, int32 newIndex)
+		{
+			for (size_t slot = (size_t)key.GetHash() & Mask; ; slot = (slot + 1) & Mask)
+			{
+				if (Indices[slot] == -1)
+				{
+					Keys[slot] = key;
+					Indices[slot] = newIndex;
+					return newIndex;
+				}
+				if (Keys[slot] == key)
 				{
-					index = existingIndex;
-					break;
+					return Indices[slot];
 				}
 			}
-			if (index == -1)
+		}
+
+	private:
+		std::vector<TKey> Keys;
+		std::vector<int32> Indices;
+		size_t Mask = 0;
+	};
+
+	template<class T>
+	void AppendTo(std::vector<T>& target, const std::vector<T>& source)
+	{
+		target.insert(target.end(), source.begin(), source.end());
+	}
+
+	// Compiled model layout is this header, then the vertex array and then the index array, each 16 byte aligned
+	struct CompiledModelHeader
+	{
+		static constexpr uint32 MagicValue = 0x4C444D54; // "TMDL"
+		static constexpr uint32 CurrentVersion = 1;
+
+		uint32 Magic = MagicValue;
+		uint32 Version = CurrentVersion;
+		uint64 SourceHash = 0;
+		int32 NumVertices = 0;
+		int32 NumTris = 0;
+		uint32 VertexSize = sizeof(Vertex);
+		uint32 IndexSize = 0; // 2 or 4 bytes
+		Vec3f BoundsMin;
+		Vec3f BoundsMax;
+		uint64 VertexOffset = 0;
+		uint64 IndexOffset = 0;
+	};
+
+	constexpr uint64 CompiledModelAlignment = 16;
+
+	uint64 AlignOffset(uint64 offset)
+	{
+		return (offset + CompiledModelAlignment - 1) & ~(CompiledModelAlignment - 1);
+	}
+}
+
+void Model::Reset()
+{
+	Vertices.clear();
+	Triangles.clear();
+	CompiledFile.reset();
+	Streams.reset();
+	UseOwnedData();
+}
+
+void Model::UseOwnedData()
+{
+	VertexData = Vertices.data();
+	TriData = Triangles.data();
+	TriData16 = nullptr;
+	VertexCount = (int32)Vertices.size();
+	TriCount = (int32)Triangles.size();
+}
+
+bool Model::LoadWavefrontFile(const char* FileName, const ModelLoadOptions& options)
+{
+	Reset();
+
+	MappedFile file;
+	if (!file.Open(FileName))
+	{
+		return false;
+	}
+	return LoadWavefrontData(file.GetData(), file.GetSize(), options);
+}
+
+bool Model::LoadWavefrontData(const char* data, size_t size, const ModelLoadOptions& options)
+{
+	ThreadPool* const threadPool = options.ThreadPool;
+
+	Reset();
+
+	// split into chunks of whole lines. Indices in the file are absolute, so chunks can be parsed independently and appended in order
+	constexpr size_t minChunkSize = 1 << 20;
+	int32 numChunks = 1;
+	if (threadPool != nullptr)
+	{
+		numChunks = (int32)GetMax<size_t>(GetMin<size_t>(threadPool->GetNumThreads() * 4, size / minChunkSize), 1);
+	}
+
+	std::vector<const char*> chunkStarts(numChunks + 1);
+	chunkStarts[0] = data;
+	chunkStarts[numChunks] = data + size;
+	for (int32 chunkIndex = 1; chunkIndex != numChunks; ++chunkIndex)
+	{
+		const char* start = GetMax(data + (size * chunkIndex) / numChunks, chunkStarts[chunkIndex - 1]);
+		const char* newLine = (const char*)std::memchr(start, '\n', data + size - start);
+		chunkStarts[chunkIndex] = newLine != nullptr ? newLine + 1 : data + size;
+	}
+
+	std::vector<ObjChunk> chunks(numChunks);
+	if (numChunks == 1)
+	{
+		ParseObjLines(chunkStarts[0], chunkStarts[1], chunks[0]);
+	}
+	else
+	{
+		threadPool->ParallelFor(numChunks, [&](int32 chunkIndex, int32 threadIndex)
 			{
-				index = (int32)uniqueVertices.size();
-				uniqueVertices.push_back(vertRef);
+				ParseObjLines(chunkStarts[chunkIndex], chunkStarts[chunkIndex + 1], chunks[chunkIndex]);
+			});
+	}
+
+	std::vector<Vec3f> positions;
+	std::vector<Vec2f> texCoords;
+	std::vector<Vec3f> normals;
+	std::vector<TriRef> tris;
+	if (numChunks == 1)
+	{
+		positions.swap(chunks[0].Positions);
+		texCoords.swap(chunks[0].TexCoords);
+		normals.swap(chunks[0].Normals);
+		tris.swap(chunks[0].Tris);
+	}
+	for (const ObjChunk& chunk : chunks)
+	{
+		if (!chunk.bValid)
+		{
+			return false;
+		}
+		if (numChunks != 1)
+		{
+			AppendTo(positions, chunk.Positions);
+			AppendTo(texCoords, chunk.TexCoords);
+			AppendTo(normals, chunk.Normals);
+			AppendTo(tris, chunk.Tris);
+		}
+	}
+
+	_Min = Vec3f(FLT_MAX);
+	_Max = Vec3f(FLT_MAX * -1.f);
+	for (const Vec3f& position : positions)
+	{
+		_Min = GetMin(_Min, position);
+		_Max = GetMax(_Max, position);
+	}
+
+	for (const TriRef& triRef : tris)
+	{
+		for (const VertexRef& vertRef : triRef.Vertices)
+		{
+			if ((uint32)vertRef.PosIndex >= positions.size() || (uint32)vertRef.TexCoordIndex >= texCoords.size() || (uint32)vertRef.NormalIndex >= normals.size())
+			{
+				return false;
 			}
+		}
+	}
+
+	// now convert to more standard format with vertex data grouped together, in order of first use
+	std::vector<VertexRef> uniqueVertices;
+	Triangles.reserve(tris.size());
 
-			tri.VertexIndex[triPointIndex] = index;
+	const auto weldVertices = [&](auto& weldMap, const auto& makeKey)
+	{
+		for (const TriRef& triRef : tris)
+		{
+			Tri tri;
+			for (int32 triPointIndex = 0; triPointIndex != 3; ++triPointIndex)
+			{
+				const VertexRef& vertRef = triRef.Vertices[triPointIndex];
+				const int32 index = weldMap.FindOrAdd(makeKey(vertRef), (int32)uniqueVertices.size());
+				if (index == (int32)uniqueVertices.size())
+				{
+					uniqueVertices.push_back(vertRef);
+				}
+				tri.VertexIndex[triPointIndex] = index;
+			}
+			Triangles.push_back(tri);
 		}
+	};
 
-		Triangles.push_back(tri);
+	const size_t maxUniqueVertices = tris.size() * 3;
+	if (options.bWeldByValue)
+	{
+		// positions are quantized relative to the model bounds, the other attributes absolutely.
+		// Values either side of a quantization boundary aren't welded, however close they are
+		const float positionStep = GetMax((_Max - _Min).GetMax() * options.PositionTolerance, FLT_MIN);
+		const float attributeStep = options.AttributeTolerance;
+		VertexWeldMap<WeldKey<8>> weldMap(maxUniqueVertices);
+		weldVertices(weldMap, [&](const VertexRef& vertRef)
+			{
+				const Vec3f position = (positions[vertRef.PosIndex] - _Min) / positionStep;
+				const Vec2f texCoord = texCoords[vertRef.TexCoordIndex] * (1.f / attributeStep);
+				const Vec3f normal = normals[vertRef.NormalIndex] / attributeStep;
+				return WeldKey<8>{ {
+					GetRoundToInt(position.X), GetRoundToInt(position.Y), GetRoundToInt(position.Z),
+					GetRoundToInt(texCoord.X), GetRoundToInt(texCoord.Y),
+					GetRoundToInt(normal.X), GetRoundToInt(normal.Y), GetRoundToInt(normal.Z) } };
+			});
+	}
+	else
+	{
+		VertexWeldMap<WeldKey<3>> weldMap(maxUniqueVertices);
+		weldVertices(weldMap, [](const VertexRef& vertRef)
+			{
+				return WeldKey<3>{ { vertRef.PosIndex, vertRef.TexCoordIndex, vertRef.NormalIndex } };
+			});
 	}
+
+	Vertices.reserve(uniqueVertices.size());
 	for (const VertexRef& uniqueVertex : uniqueVertices)
 	{
 		Vertex vertex;
@@ -144,11 +440,252 @@ bool Model::LoadWavefrontFile(const char* FileName)
 		Vertices.push_back(vertex);
 	}
 
+	UseOwnedData();
+
+	if (options.bOptimize)
+	{
+		Optimize();
+	}
+	if (options.bVertexStreams)
+	{
+		BuildVertexStreams();
+	}
 	return IsValid();
 }
 
+bool Model::SaveCompiled(const char* fileName, uint64 sourceHash) const
+{
+	if (!IsValid())
+	{
+		return false;
+	}
+
+	CompiledModelHeader header;
+	header.SourceHash = sourceHash;
+	header.NumVertices = VertexCount;
+	header.NumTris = TriCount;
+	header.IndexSize = VertexCount <= 0x10000 ? sizeof(uint16) : sizeof(int32);
+	header.BoundsMin = _Min;
+	header.BoundsMax = _Max;
+	header.VertexOffset = AlignOffset(sizeof(CompiledModelHeader));
+	header.IndexOffset = AlignOffset(header.VertexOffset + (uint64)VertexCount * sizeof(Vertex));
+
+	// write to a temporary file which is renamed once complete, so processes loading concurrently never see a partial file
+	const std::string tempFileName = std::string(fileName) + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()) ^ (size_t)std::chrono::steady_clock::now().time_since_epoch().count()) + ".tmp";
+	{
+		std::ofstream out(tempFileName, std::ios::binary);
+		if (!out.is_open())
+		{
+			return false;
+		}
+
+		const char padding[CompiledModelAlignment] = {};
+		out.write((const char*)&header, sizeof(header));
+		out.write(padding, header.VertexOffset - sizeof(header));
+		out.write((const char*)VertexData, (std::streamsize)VertexCount * sizeof(Vertex));
+		out.write(padding, header.IndexOffset - (header.VertexOffset + (uint64)VertexCount * sizeof(Vertex)));
+
+		if (header.IndexSize == sizeof(uint16))
+		{
+			std::vector<uint16> indices;
+			indices.reserve((size_t)TriCount * 3);
+			for (int32 triIndex = 0; triIndex != TriCount; ++triIndex)
+			{
+				for (const int32 vertexIndex : GetTri(triIndex).VertexIndex)
+				{
+					indices.push_back((uint16)vertexIndex);
+				}
+			}
+			out.write((const char*)indices.data(), (std::streamsize)indices.size() * sizeof(uint16));
+		}
+		else
+		{
+			out.write((const char*)TriData, (std::streamsize)TriCount * sizeof(Tri));
+		}
+
+		if (!out.good())
+		{
+			out.close();
+			std::filesystem::remove(tempFileName);
+			return false;
+		}
+	}
+
+	std::error_code error;
+	std::filesystem::rename(tempFileName, fileName, error);
+	if (error)
+	{
+		std::filesystem::remove(tempFileName, error);
+		return false;
+	}
+	return true;
+}
+
+bool Model::LoadCompiled(const char* fileName, uint64 sourceHash)
+{
+	Reset();
+
+	std::unique_ptr<MappedFile> file = std::make_unique<MappedFile>();
+	if (!file->Open(fileName) || file->GetSize() < sizeof(CompiledModelHeader))
+	{
+		return false;
+	}
+
+	// the contents are trusted once the header checks out, so loading never touches the data itself
+	CompiledModelHeader header;
+	std::memcpy(&header, file->GetData(), sizeof(header));
+	if (header.Magic != CompiledModelHeader::MagicValue
+		|| header.Version != CompiledModelHeader::CurrentVersion
+		|| header.SourceHash != sourceHash
+		|| header.VertexSize != sizeof(Vertex)
+		|| (header.IndexSize != sizeof(uint16) && header.IndexSize != sizeof(int32))
+		|| header.NumVertices <= 0 || header.NumTris <= 0
+		|| header.VertexOffset % CompiledModelAlignment != 0 || header.IndexOffset % CompiledModelAlignment != 0
+		|| header.VertexOffset + (uint64)header.NumVertices * sizeof(Vertex) > file->GetSize()
+		|| header.IndexOffset + (uint64)header.NumTris * 3 * header.IndexSize > file->GetSize())
+	{
+		return false;
+	}
+
+	const char* const data = file->GetData();
+	VertexData = (const Vertex*)(data + header.VertexOffset);
+	if (header.IndexSize == sizeof(uint16))
+	{
+		TriData16 = (const uint16*)(data + header.IndexOffset);
+	}
+	else
+	{
+		TriData = (const Tri*)(data + header.IndexOffset);
+	}
+	VertexCount = header.NumVertices;
+	TriCount = header.NumTris;
+	_Min = header.BoundsMin;
+	_Max = header.BoundsMax;
+	CompiledFile = std::move(file);
+	return true;
+}
+
+bool Model::LoadWavefrontFileCached(const char* fileName, const char* compiledFileName, const ModelLoadOptions& options)
+{
+	MappedFile file;
+	if (!file.Open(fileName))
+	{
+		Reset();
+		return false;
+	}
+
+	// the compiled model depends on the options which change the resulting model as well as the file contents
+	struct
+	{
+		uint32 Version = CompiledModelHeader::CurrentVersion;
+		uint32 bWeldByValue;
+		float PositionTolerance;
+		float AttributeTolerance;
+		uint32 bOptimize;
+	} optionsKey;
+	optionsKey.bWeldByValue = options.bWeldByValue ? 1 : 0;
+	optionsKey.bOptimize = options.bOptimize ? 1 : 0;
+	optionsKey.PositionTolerance = options.bWeldByValue ? options.PositionTolerance : 0.f;
+	optionsKey.AttributeTolerance = options.bWeldByValue ? options.AttributeTolerance : 0.f;
+	const uint64 sourceHash = ComputeHash(&optionsKey, sizeof(optionsKey), ComputeHash(file.GetData(), file.GetSize()));
+
+	// streams are built after loading either way, so they don't affect the compiled model
+	if (LoadCompiled(compiledFileName, sourceHash))
+	{
+		if (options.bVertexStreams)
+		{
+			BuildVertexStreams();
+		}
+		return true;
+	}
+
+	if (!LoadWavefrontData(file.GetData(), file.GetSize(), options))
+	{
+		return false;
+	}
+
+	// the model is fine even if it can't be cached
+	SaveCompiled(compiledFileName, sourceHash);
+	return true;
+}
+
 TV::Maths::Vec3f Model::CalculateNormal(int32 triIndex) const
 {
 	const Tri& tri = GetTri(triIndex);
 	return TV::Renderer::CalculateNormal(GetVertex(tri.VertexIndex[0]), GetVertex(tri.VertexIndex[1]), GetVertex(tri.VertexIndex[2]));
-}
\ No newline at end of file
+}
+
+void Model::BuildVertexStreams()
+{
+	if (Streams == nullptr)
+	{
+		Streams = std::make_unique<VertexStreams>();
+	}
+
+	std::vector<float>* const streams[] = { &Streams->PositionX, &Streams->PositionY, &Streams->PositionZ, &Streams->TexCoordX, &Streams->TexCoordY, &Streams->NormalX, &Streams->NormalY, &Streams->NormalZ };
+	for (std::vector<float>* const stream : streams)
+	{
+		stream->resize(VertexCount);
+	}
+
+	for (int32 vertexIndex = 0; vertexIndex != VertexCount; ++vertexIndex)
+	{
+		const Vertex& vertex = VertexData[vertexIndex];
+		Streams->PositionX[vertexIndex] = vertex.Position.X;
+		Streams->PositionY[vertexIndex] = vertex.Position.Y;
+		Streams->PositionZ[vertexIndex] = vertex.Position.Z;
+		Streams->TexCoordX[vertexIndex] = vertex.TexCoord.X;
+		Streams->TexCoordY[vertexIndex] = vertex.TexCoord.Y;
+		Streams->NormalX[vertexIndex] = vertex.Normal.X;
+		Streams->NormalY[vertexIndex] = vertex.Normal.Y;
+		Streams->NormalZ[vertexIndex] = vertex.Normal.Z;
+	}
+}
+
+TV::Renderer::ModelOptimizationStats Model::Optimize(int32 cacheSize, float overdrawThreshold)
+{
+	const bool bHadStreams = Streams != nullptr;
+
+	// a mapped model is read only, so take a copy to work on
+	if (CompiledFile != nullptr)
+	{
+		std::vector<Vertex> vertices(VertexData, VertexData + VertexCount);
+		std::vector<Tri> triangles;
+		triangles.reserve(TriCount);
+		for (int32 triIndex = 0; triIndex != TriCount; ++triIndex)
+		{
+			triangles.push_back(GetTri(triIndex));
+		}
+		Reset();
+		Vertices.swap(vertices);
+		Triangles.swap(triangles);
+	}
+
+	ModelOptimizationStats stats;
+	stats.ACMRBefore = TV::Renderer::ComputeACMR(Triangles, (int32)Vertices.size(), cacheSize);
+
+	std::vector<int32> clusterStarts;
+	OptimizeVertexCache(Triangles, (int32)Vertices.size(), cacheSize, &clusterStarts);
+	OptimizeOverdraw(Triangles, Vertices, clusterStarts, cacheSize, overdrawThreshold);
+	OptimizeVertexFetch(Triangles, Vertices);
+	UseOwnedData();
+
+	if (bHadStreams)
+	{
+		BuildVertexStreams();
+	}
+
+	stats.ACMRAfter = ComputeACMR(cacheSize);
+	return stats;
+}
+
+float Model::ComputeACMR(int32 cacheSize) const
+{
+	std::vector<Tri> triangles;
+	triangles.reserve(TriCount);
+	for (int32 triIndex = 0; triIndex != TriCount; ++triIndex)
+	{
+		triangles.push_back(GetTri(triIndex));
+	}
+	return TV::Renderer::ComputeACMR(triangles, VertexCount, cacheSize);
+}
@@ -2,9 +2,11 @@
 
 #include "../Maths/Vec3.h"
 
+#include <memory>
 #include <vector>
 #include "../Maths/Types.h"
 #include "../Renderer/Vertex.h"
+#include "MappedFile.h"
 
 namespace TV
 {
@@ -12,28 +14,93 @@ namespace TV
 	{
 		using namespace Maths;
 
+		class ThreadPool;
+
+		struct ModelLoadOptions
+		{
+			Renderer::ThreadPool* ThreadPool = nullptr; // optional, if set large files are split up and parsed in parallel
+
+			// Vertices are normally welded when they share position, tex coord and normal indices in the file.
+			// If set they are instead welded when their values match once quantized, for files which duplicate data
+			bool bWeldByValue = false;
+			float PositionTolerance = 1e-5f; // fraction of the model's largest dimension
+			float AttributeTolerance = 1e-4f; // absolute, for tex coords and normals
+
+			bool bOptimize = false; // runs Model::Optimize after loading
+			bool bVertexStreams = false; // runs Model::BuildVertexStreams after loading
+		};
+
+		// vertex data split into a separate array per component, for shading vertices several at a time with simd
+		struct VertexStreams
+		{
+			std::vector<float> PositionX;
+			std::vector<float> PositionY;
+			std::vector<float> PositionZ;
+			std::vector<float> TexCoordX;
+			std::vector<float> TexCoordY;
+			std::vector<float> NormalX;
+			std::vector<float> NormalY;
+			std::vector<float> NormalZ;
+		};
+
+		struct ModelOptimizationStats
+		{
+			float ACMRBefore = 0.f; // average post-transform cache misses per triangle
+			float ACMRAfter = 0.f;
+		};
+
 		class Model
 		{
 		public:
 			Model() {}
 
-			bool IsValid() const { return !Triangles.empty() && !Vertices.empty(); }
+			// may point into its own storage
+			Model(const Model&) = delete;
+			Model& operator = (const Model&) = delete;
+
+			bool IsValid() const { return TriCount > 0 && VertexCount > 0; }
+
+			bool LoadWavefrontFile(const char* fileName, const ModelLoadOptions& options = ModelLoadOptions());
 
-			bool LoadWavefrontFile(const char* fileName);
+			// A compiled model is a binary image of the model which is memory mapped and used in place, with no parsing or copying.
+			// sourceHash identifies what it was built from, loading fails if it doesn't match the hash it was saved with
+			bool SaveCompiled(const char* fileName, uint64 sourceHash) const;
+			bool LoadCompiled(const char* fileName, uint64 sourceHash);
 
-			int32 NumTris() const { return (int32)Triangles.size(); }
-			int32 NumVertices() const { return (int32)Vertices.size(); }
+			// loads the compiled model if it was built from the same OBJ contents and options, otherwise loads the OBJ and compiles it
+			bool LoadWavefrontFileCached(const char* fileName, const char* compiledFileName, const ModelLoadOptions& options = ModelLoadOptions());
+
+			int32 NumTris() const { return TriCount; }
+			int32 NumVertices() const { return VertexCount; }
 
 			struct Tri
 			{
 				int32 VertexIndex[3];
 			};
-			const Tri& GetTri(int32 index) const { return Triangles[index]; }
+			Tri GetTri(int32 index) const
+			{
+				if (TriData16 != nullptr)
+				{
+					const uint16* const indices = TriData16 + index * 3;
+					return Tri{ { indices[0], indices[1], indices[2] } };
+				}
+				return TriData[index];
+			}
 
-			const Vertex& GetVertex(int32 index) const { return Vertices[index]; }
+			const Vertex& GetVertex(int32 index) const { return VertexData[index]; }
 
 			Vec3f CalculateNormal(int32 triIndex) const;
 
+			// Keeps a structure of arrays copy of the vertices alongside the usual ones, which is kept up to date by Optimize.
+			// Shaders with a batched vertex shader read from it when it exists
+			void BuildVertexStreams();
+			const VertexStreams* GetVertexStreams() const { return Streams.get(); }
+
+			// Reorders triangles for vertex cache hits and then for less overdraw, followed by vertices into the order they are used.
+			// Statistics are for a FIFO cache of cacheSize vertices
+			ModelOptimizationStats Optimize(int32 cacheSize = 16, float overdrawThreshold = 1.05f);
+			float ComputeACMR(int32 cacheSize = 16) const;
+
 			const Vec3f& GetBoundsMin() const { return _Min; }
 			const Vec3f& GetBoundsMax() const { return _Max; }
 
@@ -41,8 +108,23 @@ namespace TV
 			Vec3f GetBoundsExtents() const { return (_Max - _Min) * 0.5f; }
 
 		private:
+			void Reset();
+			void UseOwnedData();
+
+			bool LoadWavefrontData(const char* data, size_t size, const ModelLoadOptions& options);
+
+			// owned data, empty if the model is mapped from a compiled file
 			std::vector<Vertex> Vertices;
 			std::vector<Tri> Triangles;
+			std::unique_ptr<MappedFile> CompiledFile;
+			std::unique_ptr<VertexStreams> Streams;
+
+			// the data in use, wherever it lives
+			const Vertex* VertexData = nullptr;
+			const Tri* TriData = nullptr;
+			const uint16* TriData16 = nullptr; // compiled models with few enough vertices use 16 bit indices instead of TriData
+			int32 VertexCount = 0;
+			int32 TriCount = 0;
 
 			Vec3f _Min;
 			Vec3f _Max;
@@ -0,0 +1,189 @@
+#include "Clipping.h"
+
+namespace
+{
+	using namespace TV;
+	using namespace TV::Maths;
+	using namespace TV::Renderer;
+
+	// signed distance scaled by w, positive inside
+	float GetPlaneDistance(const Vec4f& position, int32 planeIndex, float guardBand)
+	{
+		switch (planeIndex)
+		{
+		case 0: return position.Z + position.W;
+		case 1: return position.W - position.Z;
+		case 2: return position.X + guardBand * position.W;
+		case 3: return guardBand * position.W - position.X;
+		case 4: return position.Y + guardBand * position.W;
+		default: return guardBand * position.W - position.Y;
+		}
+	}
+
+	Vec4f GetInterpolated(const Vec4f& a, const Vec4f& b, float alpha)
+	{
+		Vec4f ret;
+		for (int32 index = 0; index != 4; ++index)
+		{
+			ret.Raw[index] = a.Raw[index] + (b.Raw[index] - a.Raw[index]) * alpha;
+		}
+		return ret;
+	}
+
+	ClipVertex GetInterpolated(const ClipVertex& a, const ClipVertex& b, float alpha)
+	{
+		ClipVertex ret;
+		ret.Position = GetInterpolated(a.Position, b.Position, alpha);
+		ret.Weights = a.Weights + (b.Weights - a.Weights) * alpha;
+		return ret;
+	}
+}
+
+uint32 TV::Renderer::ComputeOutcode(const Vec4f& position, float guardBand)
+{
+	uint32 outcode = 0;
+	for (int32 planeIndex = 0; planeIndex != ClipPlane::Count; ++planeIndex)
+	{
+		if (GetPlaneDistance(position, planeIndex, guardBand) < 0.f)
+		{
+			outcode |= 1u << planeIndex;
+		}
+	}
+	return outcode;
+}
+
+float TV::Renderer::ComputeGuardBand(const Vec2i& canvasSize, float maxScreenCoordinate)
+{
+	// screen position = halfSize + halfSize * ndc, leave some slack for the final vertex rounding
+	const float halfSize = GetMax(canvasSize.X, canvasSize.Y) * 0.5f;
+	const float guardBand = (maxScreenCoordinate * 0.9f) / GetMax(halfSize, 1.f) - 1.f;
+	return GetMax(guardBand, 1.f);
+}
+
+TV::Renderer::ClipResult TV::Renderer::ClipTriangle(const Vec4f positions[3], float guardBand, ClipVertex output[MaxClippedVertices], int32& numVertices)
+{
+	numVertices = 0;
+
+	// reject against the real view frustum, clip against the guard band
+	uint32 frustumOutcodeAnd = ~0u;
+	uint32 clipOutcodeOr = 0;
+	for (int32 index = 0; index != 3; ++index)
+	{
+		frustumOutcodeAnd &= ComputeOutcode(positions[index], 1.f);
+		clipOutcodeOr |= ComputeOutcode(positions[index], guardBand);
+	}
+	if (frustumOutcodeAnd != 0)
+	{
+		return ClipResult::Rejected;
+	}
+	if (clipOutcodeOr == 0)
+	{
+		return ClipResult::Accepted;
+	}
+
+	// https://en.wikipedia.org/wiki/Sutherland%E2%80%93Hodgman_algorithm
+	ClipVertex buffer[MaxClippedVertices];
+	ClipVertex* input = output;
+	ClipVertex* result = buffer;
+
+	for (int32 index = 0; index != 3; ++index)
+	{
+		input[index].Position = positions[index];
+		input[index].Weights = Vec3f();
+		input[index].Weights.Raw[index] = 1.f;
+	}
+	int32 numInput = 3;
+
+	for (int32 planeIndex = 0; planeIndex != ClipPlane::Count; ++planeIndex)
+	{
+		if ((clipOutcodeOr & (1u << planeIndex)) == 0)
+		{
+			continue;
+		}
+
+		int32 numResult = 0;
+		for (int32 index = 0; index != numInput; ++index)
+		{
+			const ClipVertex& current = input[index];
+			const ClipVertex& next = input[(index + 1) % numInput];
+			const float currentDistance = GetPlaneDistance(current.Position, planeIndex, guardBand);
+			const float nextDistance = GetPlaneDistance(next.Position, planeIndex, guardBand);
+			const bool bCurrentInside = currentDistance >= 0.f;
+			const bool bNextInside = nextDistance >= 0.f;
+
+			if (bCurrentInside)
+			{
+				result[numResult++] = current;
+			}
+			if (bCurrentInside != bNextInside)
+			{
+				// always interpolate from the inside vertex, so an edge shared with a neighbour is split at exactly the same point
+				if (bCurrentInside)
+				{
+					result[numResult++] = GetInterpolated(current, next, currentDistance / (currentDistance - nextDistance));
+				}
+				else
+				{
+					result[numResult++] = GetInterpolated(next, current, nextDistance / (nextDistance - currentDistance));
+				}
+			}
+		}
+
+		if (numResult < 3)
+		{
+			return ClipResult::Rejected;
+		}
+
+		std::swap(input, result);
+		numInput = numResult;
+	}
+
+	if (input != output)
+	{
+		for (int32 index = 0; index != numInput; ++index)
+		{
+			output[index] = input[index];
+		}
+	}
+	numVertices = numInput;
+	return ClipResult::Clipped;
+}
+
+bool TV::Renderer::ClipLine(Vec4f& start, Vec4f& end, float guardBand)
+{
+	// https://en.wikipedia.org/wiki/Liang%E2%80%93Barsky_algorithm
+	float startAlpha = 0.f;
+	float endAlpha = 1.f;
+	for (int32 planeIndex = 0; planeIndex != ClipPlane::Count; ++planeIndex)
+	{
+		const float startDistance = GetPlaneDistance(start, planeIndex, guardBand);
+		const float endDistance = GetPlaneDistance(end, planeIndex, guardBand);
+		if (startDistance < 0.f && endDistance < 0.f)
+		{
+			return false;
+		}
+		if (startDistance < 0.f)
+		{
+			startAlpha = GetMax(startAlpha, startDistance / (startDistance - endDistance));
+		}
+		else if (endDistance < 0.f)
+		{
+			endAlpha = GetMin(endAlpha, startDistance / (startDistance - endDistance));
+		}
+	}
+	if (startAlpha > endAlpha)
+	{
+		return false;
+	}
+
+	const Vec4f originalStart = start;
+	if (startAlpha > 0.f)
+	{
+		start = GetInterpolated(originalStart, end, startAlpha);
+	}
+	if (endAlpha < 1.f)
+	{
+		end = GetInterpolated(originalStart, end, endAlpha);
+	}
+	return true;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "../Maths/Types.h"
+#include "../Maths/Vec3.h"
+#include "../Maths/Vec4.h"
+
+namespace TV
+{
+	namespace Renderer
+	{
+		using namespace Maths;
+
+		// Clipping happens in homogeneous clip space, against the near and far planes and a guard band in x and y.
+		// The guard band is much wider than the view so almost nothing needs clipping in x and y, it only has to keep
+		// projected coordinates small enough for the rasterizer's fixed point maths
+		namespace ClipPlane
+		{
+			enum Type : uint32
+			{
+				Near = 1 << 0,
+				Far = 1 << 1,
+				Left = 1 << 2,
+				Right = 1 << 3,
+				Bottom = 1 << 4,
+				Top = 1 << 5,
+
+				Count = 6,
+			};
+		}
+
+		// a vertex of a clipped polygon, as a blend of the vertices of the source triangle
+		struct ClipVertex
+		{
+			Vec4f Position;
+			Vec3f Weights;
+		};
+
+		// a triangle can gain one vertex per plane
+		constexpr int32 MaxClippedVertices = 3 + ClipPlane::Count;
+
+		// bitmask of the planes the position is outside of, guardBand is the multiple of w allowed in x and y
+		uint32 ComputeOutcode(const Vec4f& position, float guardBand);
+
+		// guard band to keep projected positions on a canvas of this size within maxScreenCoordinate of the origin
+		float ComputeGuardBand(const Vec2i& canvasSize, float maxScreenCoordinate);
+
+		enum class ClipResult
+		{
+			Rejected, // entirely outside the view
+			Accepted, // needs no clipping
+			Clipped,
+		};
+
+		// clips a triangle against the planes it crosses. When clipped, output holds numVertices vertices of a convex polygon
+		ClipResult ClipTriangle(const Vec4f positions[3], float guardBand, ClipVertex output[MaxClippedVertices], int32& numVertices);
+
+		// clips a line in place, returns false if nothing is left
+		bool ClipLine(Vec4f& start, Vec4f& end, float guardBand);
+	}
+}
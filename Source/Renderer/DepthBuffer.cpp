@@ -1 +1,116 @@
 #include "DepthBuffer.h"
+
+TV::Renderer::DepthBuffer::BufferType TV::Renderer::DepthBuffer::GetTileMin(int32 tileX, int32 tileY) const
+{
+	const int32 tileIndex = tileX + tileY * NumTiles.X;
+	if (TileDirty[tileIndex])
+	{
+		UpdateTileRange(tileIndex);
+	}
+	return TileMin[tileIndex];
+}
+
+TV::Renderer::DepthBuffer::BufferType TV::Renderer::DepthBuffer::GetTileMax(int32 tileX, int32 tileY) const
+{
+	const int32 tileIndex = tileX + tileY * NumTiles.X;
+	if (TileDirty[tileIndex])
+	{
+		UpdateTileRange(tileIndex);
+	}
+	return TileMax[tileIndex];
+}
+
+TV::Renderer::DepthBuffer::BufferType TV::Renderer::DepthBuffer::GetCoarseTileMin(int32 coarseTileX, int32 coarseTileY) const
+{
+	constexpr int32 tilesPerCoarseTile = CoarseTileSize / TileSize;
+
+	const int32 coarseTileIndex = coarseTileX + coarseTileY * NumCoarseTiles.X;
+	if (CoarseTileDirty[coarseTileIndex])
+	{
+		const Vec2i min(coarseTileX * tilesPerCoarseTile, coarseTileY * tilesPerCoarseTile);
+		const Vec2i max(GetMin(min.X + tilesPerCoarseTile, NumTiles.X), GetMin(min.Y + tilesPerCoarseTile, NumTiles.Y));
+
+		BufferType coarseTileMin = GetTileMin(min.X, min.Y);
+		for (int32 tileY = min.Y; tileY != max.Y; ++tileY)
+		{
+			for (int32 tileX = min.X; tileX != max.X; ++tileX)
+			{
+				coarseTileMin = GetMin(coarseTileMin, GetTileMin(tileX, tileY));
+			}
+		}
+
+		CoarseTileMin[coarseTileIndex] = coarseTileMin;
+		CoarseTileDirty[coarseTileIndex] = 0;
+	}
+	return CoarseTileMin[coarseTileIndex];
+}
+
+bool TV::Renderer::DepthBuffer::IsOccluded(const Vec2i& min, const Vec2i& max, BufferType value) const
+{
+	ValidatePoint(min);
+	ValidatePoint(max);
+
+	constexpr int32 tilesPerCoarseTile = CoarseTileSize / TileSize;
+
+	for (int32 coarseTileY = min.Y / CoarseTileSize; coarseTileY <= max.Y / CoarseTileSize; ++coarseTileY)
+	{
+		for (int32 coarseTileX = min.X / CoarseTileSize; coarseTileX <= max.X / CoarseTileSize; ++coarseTileX)
+		{
+			if (GetCoarseTileMin(coarseTileX, coarseTileY) > value)
+			{
+				continue;
+			}
+
+			// coarse tile isn't conclusive, check the tiles it shares with the rect
+			const int32 minTileX = GetMax(coarseTileX * tilesPerCoarseTile, min.X / TileSize);
+			const int32 minTileY = GetMax(coarseTileY * tilesPerCoarseTile, min.Y / TileSize);
+			const int32 maxTileX = GetMin((coarseTileX + 1) * tilesPerCoarseTile - 1, max.X / TileSize);
+			const int32 maxTileY = GetMin((coarseTileY + 1) * tilesPerCoarseTile - 1, max.Y / TileSize);
+			for (int32 tileY = minTileY; tileY <= maxTileY; ++tileY)
+			{
+				for (int32 tileX = minTileX; tileX <= maxTileX; ++tileX)
+				{
+					if (!(GetTileMin(tileX, tileY) > value))
+					{
+						return false;
+					}
+				}
+			}
+		}
+	}
+	return true;
+}
+
+void TV::Renderer::DepthBuffer::FillClearedTile(int32 tileIndex) const
+{
+	const Vec2i min((tileIndex % NumTiles.X) * TileSize, (tileIndex / NumTiles.X) * TileSize);
+	const Vec2i max(GetMin(min.X + TileSize, Size.X), GetMin(min.Y + TileSize, Size.Y));
+	for (int32 y = min.Y; y != max.Y; ++y)
+	{
+		BufferType* const row = Buffer + (size_t)y * Stride;
+		std::fill(row + min.X, row + max.X, ClearValue);
+	}
+	TileCleared[tileIndex] = 0;
+}
+
+void TV::Renderer::DepthBuffer::UpdateTileRange(int32 tileIndex) const
+{
+	const Vec2i min((tileIndex % NumTiles.X) * TileSize, (tileIndex / NumTiles.X) * TileSize);
+	const Vec2i max(GetMin(min.X + TileSize, Size.X), GetMin(min.Y + TileSize, Size.Y));
+
+	BufferType tileMin = Buffer[min.X + (size_t)min.Y * Stride];
+	BufferType tileMax = tileMin;
+	for (int32 y = min.Y; y != max.Y; ++y)
+	{
+		const BufferType* const row = Buffer + (size_t)y * Stride;
+		for (int32 x = min.X; x != max.X; ++x)
+		{
+			tileMin = GetMin(tileMin, row[x]);
+			tileMax = GetMax(tileMax, row[x]);
+		}
+	}
+
+	TileMin[tileIndex] = tileMin;
+	TileMax[tileIndex] = tileMax;
+	TileDirty[tileIndex] = 0;
+}
@@ -3,7 +3,9 @@
 #include "../Maths/Vec2.h"
 #include "../Maths/Assert.h"
 
-#include <cstring>
+#include <algorithm>
+#include <new>
+#include <vector>
 
 namespace TV
 {
@@ -16,11 +18,33 @@ namespace TV
 		public:
 			using BufferType = float;
 
-			DepthBuffer(const Vec2i& size) : Size(size), Buffer(new BufferType[size.X * size.Y])
+			// the buffer keeps the minimum (i.e. farthest) and maximum (nearest) value of each tile, so the rasterizer can skip
+			// whole tiles a triangle can't pass the depth test in, and skip the per pixel test in tiles it is entirely in front of.
+			// Coarse tiles hold the minimum of their tiles, for rejecting whole triangles
+			static constexpr int32 TileSize = 8;
+			static constexpr int32 CoarseTileSize = 32;
+
+			static constexpr BufferType ClearValue = 0.f; // the far clip plane
+
+			// rows start on a cache line, which is also enough for any simd load
+			static constexpr int32 RowAlignment = 64;
+
+			DepthBuffer(const Vec2i& size)
+				: Size(size)
+				, Stride((size.X + RowAlignment / (int32)sizeof(BufferType) - 1) & ~(RowAlignment / (int32)sizeof(BufferType) - 1))
+				, Buffer((BufferType*)::operator new[]((size_t)Stride * size.Y * sizeof(BufferType), std::align_val_t(RowAlignment)))
+				, NumTiles((size.X + TileSize - 1) / TileSize, (size.Y + TileSize - 1) / TileSize)
+				, NumCoarseTiles((size.X + CoarseTileSize - 1) / CoarseTileSize, (size.Y + CoarseTileSize - 1) / CoarseTileSize)
+				, TileMin(NumTiles.X * NumTiles.Y)
+				, TileMax(NumTiles.X * NumTiles.Y)
+				, TileDirty(NumTiles.X * NumTiles.Y) // bytes rather than bits, so neighbouring tiles can be written from different threads
+				, TileCleared(NumTiles.X * NumTiles.Y)
+				, CoarseTileMin(NumCoarseTiles.X * NumCoarseTiles.Y)
+				, CoarseTileDirty(NumCoarseTiles.X * NumCoarseTiles.Y)
 			{
 				ClearBuffer();
 			}
-			~DepthBuffer() { delete Buffer; }
+			~DepthBuffer() { ::operator delete[](Buffer, std::align_val_t(RowAlignment)); }
 
 			DepthBuffer(const DepthBuffer&) = delete;
 			DepthBuffer& operator = (const DepthBuffer&) = delete;
@@ -28,21 +52,71 @@ namespace TV
 			void Set(const Vec2i& point, BufferType value)
 			{
 				ValidatePoint(point);
-				Buffer[point.X + point.Y * Size.X] = value;
+				const int32 tileIndex = point.X / TileSize + (point.Y / TileSize) * NumTiles.X;
+				if (TileCleared[tileIndex])
+				{
+					FillClearedTile(tileIndex);
+				}
+				Buffer[point.X + (size_t)point.Y * Stride] = value;
+
+				TileDirty[tileIndex] = 1;
+				CoarseTileDirty[point.X / CoarseTileSize + (point.Y / CoarseTileSize) * NumCoarseTiles.X] = 1;
 			}
 			BufferType Get(const Vec2i& point) const
 			{
 				ValidatePoint(point);
-				return Buffer[point.X + point.Y * Size.X];
+				if (TileCleared[point.X / TileSize + (point.Y / TileSize) * NumTiles.X])
+				{
+					return ClearValue;
+				}
+				return Buffer[point.X + (size_t)point.Y * Stride];
+			}
+
+			// Direct read access to numPixels values of a row from start, for span based rasterization.
+			// Only fills in the cleared tiles the span overlaps, so is cheap enough to call for every span
+			const BufferType* GetSpan(const Vec2i& start, int32 numPixels) const
+			{
+				ValidatePoint(start);
+				check(numPixels > 0 && start.X + numPixels <= Size.X);
+				const int32 rowTileIndex = (start.Y / TileSize) * NumTiles.X;
+				for (int32 tileX = start.X / TileSize; tileX <= (start.X + numPixels - 1) / TileSize; ++tileX)
+				{
+					if (TileCleared[rowTileIndex + tileX])
+					{
+						FillClearedTile(rowTileIndex + tileX);
+					}
+				}
+				return Buffer + start.X + (size_t)start.Y * Stride;
+			}
+			// a whole row, as GetSpan
+			const BufferType* GetRow(int32 y) const
+			{
+				return GetSpan(Vec2i(0, y), Size.X);
 			}
 
 			const Vec2i& GetSize() const { return Size; }
 
+			// Fast clear, which only marks every tile as cleared rather than writing the buffer, so costs a few bytes per 8x8 pixels.
+			// A cleared tile reads as ClearValue and is filled in on the first write to it, or read of it through GetSpan
 			void ClearBuffer()
 			{
-				std::memset(Buffer, 0, Size.X * Size.Y);
+				std::fill(TileMin.begin(), TileMin.end(), ClearValue);
+				std::fill(TileMax.begin(), TileMax.end(), ClearValue);
+				std::fill(TileDirty.begin(), TileDirty.end(), (uint8)0);
+				std::fill(TileCleared.begin(), TileCleared.end(), (uint8)1);
+				std::fill(CoarseTileMin.begin(), CoarseTileMin.end(), ClearValue);
+				std::fill(CoarseTileDirty.begin(), CoarseTileDirty.end(), (uint8)0);
 			}
 
+			// minimum and maximum values in a tile, refreshed lazily after writes.
+			// Not thread safe across tiles sharing a coarse tile, threaded rasterization must split work on coarse tile boundaries
+			BufferType GetTileMin(int32 tileX, int32 tileY) const;
+			BufferType GetTileMax(int32 tileX, int32 tileY) const;
+			BufferType GetCoarseTileMin(int32 coarseTileX, int32 coarseTileY) const;
+
+			// returns true if every value in the inclusive rect is greater than value, i.e. anything at that depth would be occluded
+			bool IsOccluded(const Vec2i& min, const Vec2i& max, BufferType value) const;
+
 			void ValidatePoint(const Vec2i& point) const
 			{
 				check(point.X >= 0);
@@ -52,8 +126,24 @@ namespace TV
 			}
 
 		private:
+			// recomputes a dirty tile's minimum and maximum
+			void UpdateTileRange(int32 tileIndex) const;
+
+			// writes ClearValue to a cleared tile's memory and marks it as no longer cleared
+			void FillClearedTile(int32 tileIndex) const;
+
 			const Vec2i Size;
+			const int32 Stride; // in values, rows are padded out to RowAlignment
 			BufferType* const Buffer;
+
+			const Vec2i NumTiles;
+			const Vec2i NumCoarseTiles;
+			mutable std::vector<BufferType> TileMin;
+			mutable std::vector<BufferType> TileMax;
+			mutable std::vector<uint8> TileDirty;
+			mutable std::vector<uint8> TileCleared; // the tile's memory is stale and it reads as ClearValue
+			mutable std::vector<BufferType> CoarseTileMin;
+			mutable std::vector<uint8> CoarseTileDirty;
 		};
 	}
 }
@@ -0,0 +1,81 @@
+#include "DrawStats.h"
+#include "../Maths/Assert.h"
+
+#include <cstdio>
+
+namespace
+{
+	using namespace TV;
+
+	void AppendCounter(std::string& json, const char* name, int64 value)
+	{
+		json += std::string("\"") + name + "\": " + std::to_string(value) + ", ";
+	}
+
+	void AppendRatio(std::string& json, const char* name, double value)
+	{
+		char text[32];
+		std::snprintf(text, sizeof(text), "%.4f", value);
+		json += std::string("\"") + name + "\": " + text + ", ";
+	}
+
+#if TV_DRAW_PROFILING
+	void AppendTime(std::string& json, const char* name, int64 nanoseconds)
+	{
+		char milliseconds[32];
+		std::snprintf(milliseconds, sizeof(milliseconds), "%.3f", nanoseconds * 1e-6);
+		json += std::string("\"") + name + "\": " + milliseconds;
+	}
+#endif
+}
+
+const char* TV::Renderer::GetDrawStageName(DrawStage stage)
+{
+	switch (stage)
+	{
+	case DrawStage::VertexShading: return "VertexShading";
+	case DrawStage::Setup: return "Setup";
+	case DrawStage::Rasterization: return "Rasterization";
+	case DrawStage::DepthTest: return "DepthTest";
+	case DrawStage::FragmentShading: return "FragmentShading";
+	default:
+		check(false);
+		return "";
+	}
+}
+
+std::string TV::Renderer::DrawStats::ToJson() const
+{
+	std::string json = "{ ";
+	AppendCounter(json, "VerticesShaded", VerticesShaded);
+	AppendCounter(json, "TrianglesSubmitted", TrianglesSubmitted);
+	AppendCounter(json, "TrianglesCulled", TrianglesCulled);
+	AppendCounter(json, "TrianglesClipped", TrianglesClipped);
+	AppendCounter(json, "TrianglesDegenerate", TrianglesDegenerate);
+	AppendCounter(json, "PixelsTested", PixelsTested);
+	AppendCounter(json, "PixelsDepthAccepted", PixelsDepthAccepted);
+	AppendCounter(json, "PixelsDepthRejected", PixelsDepthRejected);
+	AppendCounter(json, "FragmentsShaded", FragmentsShaded);
+	AppendCounter(json, "PixelsWritten", PixelsWritten);
+	AppendCounter(json, "PixelsCovered", PixelsCovered);
+	AppendCounter(json, "ScratchBytes", ScratchBytes);
+	AppendRatio(json, "FragmentsShadedPerPixel", GetFragmentsShadedPerPixel());
+
+	json += std::string("\"Profiled\": ") + (TV_DRAW_PROFILING ? "true" : "false");
+#if TV_DRAW_PROFILING
+	json += ", ";
+	AppendTime(json, "DrawTimeMs", DrawTime);
+	json += ", \"StageTimeMs\": { ";
+	for (int32 stage = 0; stage != NumDrawStages; ++stage)
+	{
+		if (stage != 0)
+		{
+			json += ", ";
+		}
+		AppendTime(json, GetDrawStageName((DrawStage)stage), StageTime[stage]);
+	}
+	json += " }";
+#endif
+	json += " }";
+	return json;
+}
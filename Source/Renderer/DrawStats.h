@@ -0,0 +1,153 @@
+#pragma once
+
+#include "../Maths/Types.h"
+
+#include <atomic>
+#include <chrono>
+#include <string>
+
+// Set to 1 to time the stages of every draw. The timers read the clock a few times per triangle and per span of pixels,
+// so are left out unless asked for, in which case the stage times in DrawStats stay zero. The counters are always kept
+#ifndef TV_DRAW_PROFILING
+#define TV_DRAW_PROFILING 0
+#endif
+
+namespace TV
+{
+	namespace Renderer
+	{
+		enum class DrawStage
+		{
+			VertexShading,
+			Setup, // clipping, culling and per triangle setup
+			Rasterization, // finding covered pixels. The edge function path's span functions also do the per pixel depth test, which is counted here
+			DepthTest, // hierarchical depth rejection of triangles and tiles, and per pixel tests outside the span functions
+			FragmentShading, // interpolation, shading and writing, or recording fragments in and then resolving a visibility buffer
+
+			Num,
+		};
+		constexpr int32 NumDrawStages = (int32)DrawStage::Num;
+
+		const char* GetDrawStageName(DrawStage stage);
+
+		// Counts of work done by the last draw call, in pipeline order. FragmentsShaded over PixelsCovered is the number of fragments
+		// shaded per visible pixel, which is the overdraw of forward rendering, and 1 with a visibility buffer
+		struct DrawStats
+		{
+			alignas(8) int64 VerticesShaded = 0; // vertex shader invocations
+			alignas(8) int64 TrianglesSubmitted = 0; // triangles drawn, before clipping
+			alignas(8) int64 TrianglesCulled = 0; // dropped for facing the culled way or being entirely outside the view
+			alignas(8) int64 TrianglesClipped = 0; // crossing the edge of the view, so split up by clipping
+			alignas(8) int64 TrianglesDegenerate = 0; // dropped for having zero area or covering no pixel centres
+			alignas(8) int64 PixelsTested = 0; // covered pixels depth tested individually, so not those in tiles rejected or accepted by the hierarchical test
+			alignas(8) int64 PixelsDepthAccepted = 0; // covered pixels which passed without a test, being in tiles entirely behind the triangle
+			alignas(8) int64 PixelsDepthRejected = 0; // tested pixels which failed
+			alignas(8) int64 FragmentsShaded = 0; // fragment shader invocations
+			alignas(8) int64 PixelsWritten = 0; // colour writes, including overwrites
+			alignas(8) int64 PixelsCovered = 0; // distinct pixels the draw wrote colour, or a visibility buffer entry, to at least once
+			alignas(8) int64 ScratchBytes = 0; // frame arena memory used, see RenderContext::Arena
+
+			// Nanoseconds spent in each stage, summed over threads so with a thread pool they can add up to more than the draw took.
+			// Only measured with TV_DRAW_PROFILING
+			alignas(8) int64 StageTime[NumDrawStages] = {};
+			alignas(8) int64 DrawTime = 0; // wall clock nanoseconds for the whole draw
+
+			// safe to call from several threads at once
+			void Accumulate(const DrawStats& other)
+			{
+				const auto add = [](int64& total, int64 value)
+				{
+					std::atomic_ref<int64>(total).fetch_add(value, std::memory_order_relaxed);
+				};
+				add(VerticesShaded, other.VerticesShaded);
+				add(TrianglesSubmitted, other.TrianglesSubmitted);
+				add(TrianglesCulled, other.TrianglesCulled);
+				add(TrianglesClipped, other.TrianglesClipped);
+				add(TrianglesDegenerate, other.TrianglesDegenerate);
+				add(PixelsTested, other.PixelsTested);
+				add(PixelsDepthAccepted, other.PixelsDepthAccepted);
+				add(PixelsDepthRejected, other.PixelsDepthRejected);
+				add(FragmentsShaded, other.FragmentsShaded);
+				add(PixelsWritten, other.PixelsWritten);
+				add(PixelsCovered, other.PixelsCovered);
+				add(ScratchBytes, other.ScratchBytes);
+#if TV_DRAW_PROFILING
+				for (int32 stage = 0; stage != NumDrawStages; ++stage)
+				{
+					add(StageTime[stage], other.StageTime[stage]);
+				}
+				add(DrawTime, other.DrawTime);
+#endif
+			}
+
+			// 0 if the draw covered no pixels
+			double GetFragmentsShadedPerPixel() const
+			{
+				return PixelsCovered != 0 ? (double)FragmentsShaded / (double)PixelsCovered : 0.0;
+			}
+
+			// a JSON object holding every counter and FragmentsShadedPerPixel, and the times in milliseconds when they were measured
+			std::string ToJson() const;
+		};
+
+		// nanoseconds since an arbitrary point, for the draw timers
+		inline int64 GetDrawProfileTime()
+		{
+			return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+		}
+
+		// Adds the time it is running to one stage of a DrawStats, and can be moved from stage to stage with a single clock read.
+		// Compiles to nothing without TV_DRAW_PROFILING
+		class DrawStageTimer
+		{
+		public:
+			DrawStageTimer(const DrawStageTimer&) = delete;
+			DrawStageTimer& operator = (const DrawStageTimer&) = delete;
+
+#if TV_DRAW_PROFILING
+			DrawStageTimer(DrawStats& stats, DrawStage stage) : Stats(stats), Stage(stage), StartTime(GetDrawProfileTime()) {}
+			~DrawStageTimer() { Pause(); }
+
+			// charges the time so far to the current stage and carries on timing the given one
+			void Switch(DrawStage stage)
+			{
+				const int64 time = GetDrawProfileTime();
+				if (bRunning)
+				{
+					Stats.StageTime[(int32)Stage] += time - StartTime;
+				}
+				Stage = stage;
+				StartTime = time;
+				bRunning = true;
+			}
+
+			// stops timing while other work is done, e.g. by a callback
+			void Pause()
+			{
+				if (bRunning)
+				{
+					Stats.StageTime[(int32)Stage] += GetDrawProfileTime() - StartTime;
+					bRunning = false;
+				}
+			}
+			void Resume()
+			{
+				StartTime = GetDrawProfileTime();
+				bRunning = true;
+			}
+
+		private:
+			DrawStats& Stats;
+			DrawStage Stage;
+			int64 StartTime;
+			bool bRunning = true;
+#else
+			DrawStageTimer(DrawStats&, DrawStage) {}
+
+			void Switch(DrawStage) {}
+			void Pause() {}
+			void Resume() {}
+#endif
+		};
+	}
+}
@@ -40,7 +40,7 @@ void TV::Renderer::DrawLine(Vec2i start, Vec2i end, ICanvas& canvas, const Colou
 	{
 		for (int32 x = start.X; x != end.X; ++x)
 		{
-			canvas.SetPixel(Vec2i(y, x), colour);
+			canvas.WritePixel(Vec2i(y, x), colour);
 
 			error += deltaError;
 			if (error > delta.X)
@@ -54,7 +54,7 @@ void TV::Renderer::DrawLine(Vec2i start, Vec2i end, ICanvas& canvas, const Colou
 	{
 		for (int32 x = start.X; x != end.X; ++x)
 		{
-			canvas.SetPixel(Vec2i(x, y), colour);
+			canvas.WritePixel(Vec2i(x, y), colour);
 
 			error += deltaError;
 			if (error > delta.X)
@@ -107,10 +107,7 @@ namespace TV
 				{
 					std::swap(start, end);
 				}
-				for (int32 x = start.X; x <= end.X; ++x)
-				{
-					canvas.SetPixel(Vec2i(x, y), colour);
-				}
+				canvas.FillSpan(Vec2i(start.X, y), end.X - start.X + 1, colour);
 			}
 
 			// and also fill in the middle line
@@ -121,10 +118,7 @@ namespace TV
 				const int32 otherX = GetLerp(a, c, alpha).X;
 				const int32 minX = GetMin(b.X, otherX);
 				const int32 maxX = GetMax(b.X, otherX);
-				for (int32 x = minX; x != maxX; ++x)
-				{
-					canvas.SetPixel(Vec2i(x, y), colour);
-				}
+				canvas.FillSpan(Vec2i(minX, y), maxX - minX, colour);
 			}
 		}
 
@@ -147,7 +141,7 @@ namespace TV
 				{
 					if (PointInPoly2D(ToFloat(Vec2i(x, y)), af, bf, cf))
 					{
-						canvas.SetPixel(Vec2i(x, y), colour);
+						canvas.WritePixel(Vec2i(x, y), colour);
 					}
 				}
 			}
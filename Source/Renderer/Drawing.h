@@ -17,5 +17,9 @@ namespace TV
 		void DrawLine(int32 x0, int32 y0, int32 x1, int32 y1, ICanvas& canvas, const Colour& colour);
 
 		void DrawTriangle(Vec2i a, Vec2i b, Vec2i c, ICanvas& canvas, const Colour& colour);
+
+		// the two ways of filling a flat triangle, DrawTriangle uses the line fill. The barycentric one tests every pixel in the bounding box
+		void DrawTriangle_LineFill(Vec2i a, Vec2i b, Vec2i c, ICanvas& canvas, const Colour& colour);
+		void DrawTriangle_Barycentric(Vec2i a, Vec2i b, Vec2i c, ICanvas& canvas, const Colour& colour);
 	}
 }
\ No newline at end of file
@@ -0,0 +1,326 @@
+#include "EdgeRasterizer.h"
+
+#include "../Maths/Geometry.h"
+
+#if TV_SIMD_X86
+#include <immintrin.h>
+#endif
+
+bool TV::Renderer::TriangleEdges::IsInRange(const Vec2f screenPositions[3])
+{
+	for (int32 index = 0; index != 3; ++index)
+	{
+		// also rejects NaN
+		if (!(GetAbs(screenPositions[index].X) < MaxCoordinate && GetAbs(screenPositions[index].Y) < MaxCoordinate))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool TV::Renderer::TriangleEdges::Setup(const Vec2f screenPositions[3])
+{
+	// https://www.cs.drexel.edu/~david/Classes/Papers/comp175-06-pineda.pdf
+	// https://fgiesen.wordpress.com/2013/02/08/triangle-rasterization-in-practice/
+
+	constexpr float subPixelScale = (float)(1 << SubPixelBits);
+
+	int64 fixedX[3];
+	int64 fixedY[3];
+	for (int32 index = 0; index != 3; ++index)
+	{
+		fixedX[index] = GetRoundToInt(screenPositions[index].X * subPixelScale);
+		fixedY[index] = GetRoundToInt(screenPositions[index].Y * subPixelScale);
+	}
+
+	// edge from vertex a to b, evaluated at p: (b - a) x (p - a)
+	int64 constant[3];
+	for (int32 edgeIndex = 0; edgeIndex != 3; ++edgeIndex)
+	{
+		const int32 a = (edgeIndex + 1) % 3;
+		const int32 b = (edgeIndex + 2) % 3;
+		StepX[edgeIndex] = fixedY[a] - fixedY[b];
+		StepY[edgeIndex] = fixedX[b] - fixedX[a];
+		constant[edgeIndex] = fixedX[a] * fixedY[b] - fixedY[a] * fixedX[b];
+	}
+
+	int64 doubleArea = StepX[0] * fixedX[0] + StepY[0] * fixedY[0] + constant[0];
+	if (doubleArea == 0)
+	{
+		return false;
+	}
+
+	// flip so the inside is positive for either winding
+	if (doubleArea < 0)
+	{
+		for (int32 edgeIndex = 0; edgeIndex != 3; ++edgeIndex)
+		{
+			StepX[edgeIndex] *= -1;
+			StepY[edgeIndex] *= -1;
+			constant[edgeIndex] *= -1;
+		}
+		doubleArea *= -1;
+	}
+	InvArea = (float)(1.0 / (double)doubleArea);
+
+	for (int32 edgeIndex = 0; edgeIndex != 3; ++edgeIndex)
+	{
+		// pixels exactly on an edge are only drawn for top or left edges, so shared edges are drawn exactly once
+		const bool bTopLeft = StepX[edgeIndex] > 0 || (StepX[edgeIndex] == 0 && StepY[edgeIndex] < 0);
+		Bias[edgeIndex] = bTopLeft ? 0 : 1;
+
+		// sample points are at whole pixel coordinates
+		Origin[edgeIndex] = constant[edgeIndex] - Bias[edgeIndex];
+		StepX[edgeIndex] <<= SubPixelBits;
+		StepY[edgeIndex] <<= SubPixelBits;
+	}
+
+	return true;
+}
+
+namespace
+{
+	using namespace TV;
+	using namespace TV::Renderer;
+
+	uint64 RasterSpan_Scalar(const RasterSpanInput& input, RasterSpanOutput& output)
+	{
+		const TriangleEdges& edges = *input.Edges;
+		int64 edgeValues[3] = { input.EdgeValues[0], input.EdgeValues[1], input.EdgeValues[2] };
+
+		uint64 mask = 0;
+		uint64 coverageMask = 0;
+		for (int32 index = 0; index != input.NumPixels; ++index)
+		{
+			if ((edgeValues[0] | edgeValues[1] | edgeValues[2]) >= 0)
+			{
+				coverageMask |= 1ull << index;
+				const Vec3f barycentric = edges.GetBarycentric(edgeValues);
+
+				// result should be in range [-1,1] where -1 = near clip, 1 = far clip
+				const float depth = ComputeValueFromBarycentric(barycentric, input.VertexDepths[0], input.VertexDepths[1], input.VertexDepths[2]);
+
+				// remap value for depth buffer such that 0 = far clip, 1 = near clip
+				const float depthBufferValue = 1.f - ((depth * 0.5f) + 0.5f);
+
+				const bool bPassed = input.DepthRow == nullptr || !(input.DepthRow[index] > depthBufferValue);
+				if (bPassed)
+				{
+					output.Barycentric[0][index] = barycentric.X;
+					output.Barycentric[1][index] = barycentric.Y;
+					output.Barycentric[2][index] = barycentric.Z;
+					output.DepthBufferValue[index] = depthBufferValue;
+					mask |= 1ull << index;
+				}
+			}
+
+			edgeValues[0] += edges.StepX[0];
+			edgeValues[1] += edges.StepX[1];
+			edgeValues[2] += edges.StepX[2];
+		}
+		output.CoverageMask = coverageMask;
+		return mask;
+	}
+
+#if TV_SIMD_X86
+	// edge values are kept in doubles, which represent the fixed point values exactly, since there are no 64 bit
+	// integer compares or conversions to float below avx512. Float maths matches the scalar path operation for operation
+
+	TV_TARGET_SSE2 uint64 RasterSpan_SSE2(const RasterSpanInput& input, RasterSpanOutput& output)
+	{
+		constexpr int32 laneCount = 4;
+
+		const TriangleEdges& edges = *input.Edges;
+
+		__m128d edgeValuesLo[3];
+		__m128d edgeValuesHi[3];
+		__m128d edgeSteps[3];
+		__m128d biases[3];
+		__m128 vertexDepths[3];
+		for (int32 edgeIndex = 0; edgeIndex != 3; ++edgeIndex)
+		{
+			const double stepX = (double)edges.StepX[edgeIndex];
+			edgeValuesLo[edgeIndex] = _mm_add_pd(_mm_set1_pd((double)input.EdgeValues[edgeIndex]), _mm_mul_pd(_mm_set_pd(1.0, 0.0), _mm_set1_pd(stepX)));
+			edgeValuesHi[edgeIndex] = _mm_add_pd(edgeValuesLo[edgeIndex], _mm_set1_pd(stepX * 2.0));
+			edgeSteps[edgeIndex] = _mm_set1_pd(stepX * laneCount);
+			biases[edgeIndex] = _mm_set1_pd((double)edges.Bias[edgeIndex]);
+			vertexDepths[edgeIndex] = _mm_set1_ps(input.VertexDepths[edgeIndex]);
+		}
+		const __m128d zero = _mm_setzero_pd();
+		const __m128 invArea = _mm_set1_ps(edges.InvArea);
+		const __m128 one = _mm_set1_ps(1.f);
+		const __m128 half = _mm_set1_ps(0.5f);
+
+		uint64 mask = 0;
+		uint64 coverageMask = 0;
+		for (int32 baseIndex = 0; baseIndex < input.NumPixels; baseIndex += laneCount)
+		{
+			const __m128d insideLo = _mm_and_pd(_mm_and_pd(_mm_cmpge_pd(edgeValuesLo[0], zero), _mm_cmpge_pd(edgeValuesLo[1], zero)), _mm_cmpge_pd(edgeValuesLo[2], zero));
+			const __m128d insideHi = _mm_and_pd(_mm_and_pd(_mm_cmpge_pd(edgeValuesHi[0], zero), _mm_cmpge_pd(edgeValuesHi[1], zero)), _mm_cmpge_pd(edgeValuesHi[2], zero));
+			uint32 coverage = (uint32)(_mm_movemask_pd(insideLo) | (_mm_movemask_pd(insideHi) << 2));
+
+			const int32 remaining = input.NumPixels - baseIndex;
+			if (remaining < laneCount)
+			{
+				coverage &= (1u << remaining) - 1;
+			}
+
+			if (coverage != 0)
+			{
+				coverageMask |= (uint64)coverage << baseIndex;
+
+				__m128 barycentric[3];
+				for (int32 edgeIndex = 0; edgeIndex != 3; ++edgeIndex)
+				{
+					const __m128 lo = _mm_cvtpd_ps(_mm_add_pd(edgeValuesLo[edgeIndex], biases[edgeIndex]));
+					const __m128 hi = _mm_cvtpd_ps(_mm_add_pd(edgeValuesHi[edgeIndex], biases[edgeIndex]));
+					barycentric[edgeIndex] = _mm_mul_ps(_mm_movelh_ps(lo, hi), invArea);
+					_mm_store_ps(output.Barycentric[edgeIndex] + baseIndex, barycentric[edgeIndex]);
+				}
+
+				const __m128 depth = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vertexDepths[0], barycentric[0]), _mm_mul_ps(vertexDepths[1], barycentric[1])), _mm_mul_ps(vertexDepths[2], barycentric[2]));
+				const __m128 depthBufferValue = _mm_sub_ps(one, _mm_add_ps(_mm_mul_ps(depth, half), half));
+				_mm_store_ps(output.DepthBufferValue + baseIndex, depthBufferValue);
+
+				if (input.DepthRow != nullptr)
+				{
+					__m128 stored;
+					if (remaining >= laneCount)
+					{
+						stored = _mm_loadu_ps(input.DepthRow + baseIndex);
+					}
+					else
+					{
+						alignas(16) float padded[laneCount] = {};
+						for (int32 index = 0; index != remaining; ++index)
+						{
+							padded[index] = input.DepthRow[baseIndex + index];
+						}
+						stored = _mm_load_ps(padded);
+					}
+
+					const __m128 rejected = _mm_cmpgt_ps(stored, depthBufferValue);
+					coverage &= ~(uint32)_mm_movemask_ps(rejected);
+				}
+
+				mask |= (uint64)coverage << baseIndex;
+			}
+
+			for (int32 edgeIndex = 0; edgeIndex != 3; ++edgeIndex)
+			{
+				edgeValuesLo[edgeIndex] = _mm_add_pd(edgeValuesLo[edgeIndex], edgeSteps[edgeIndex]);
+				edgeValuesHi[edgeIndex] = _mm_add_pd(edgeValuesHi[edgeIndex], edgeSteps[edgeIndex]);
+			}
+		}
+		output.CoverageMask = coverageMask;
+		return mask;
+	}
+
+	TV_TARGET_AVX2 uint64 RasterSpan_AVX2(const RasterSpanInput& input, RasterSpanOutput& output)
+	{
+		constexpr int32 laneCount = 8;
+
+		const TriangleEdges& edges = *input.Edges;
+
+		__m256d edgeValuesLo[3];
+		__m256d edgeValuesHi[3];
+		__m256d edgeSteps[3];
+		__m256d biases[3];
+		__m256 vertexDepths[3];
+		for (int32 edgeIndex = 0; edgeIndex != 3; ++edgeIndex)
+		{
+			const double stepX = (double)edges.StepX[edgeIndex];
+			edgeValuesLo[edgeIndex] = _mm256_add_pd(_mm256_set1_pd((double)input.EdgeValues[edgeIndex]), _mm256_mul_pd(_mm256_set_pd(3.0, 2.0, 1.0, 0.0), _mm256_set1_pd(stepX)));
+			edgeValuesHi[edgeIndex] = _mm256_add_pd(edgeValuesLo[edgeIndex], _mm256_set1_pd(stepX * 4.0));
+			edgeSteps[edgeIndex] = _mm256_set1_pd(stepX * laneCount);
+			biases[edgeIndex] = _mm256_set1_pd((double)edges.Bias[edgeIndex]);
+			vertexDepths[edgeIndex] = _mm256_set1_ps(input.VertexDepths[edgeIndex]);
+		}
+		const __m256d zero = _mm256_setzero_pd();
+		const __m256 invArea = _mm256_set1_ps(edges.InvArea);
+		const __m256 one = _mm256_set1_ps(1.f);
+		const __m256 half = _mm256_set1_ps(0.5f);
+
+		uint64 mask = 0;
+		uint64 coverageMask = 0;
+		for (int32 baseIndex = 0; baseIndex < input.NumPixels; baseIndex += laneCount)
+		{
+			const __m256d insideLo = _mm256_and_pd(_mm256_and_pd(_mm256_cmp_pd(edgeValuesLo[0], zero, _CMP_GE_OQ), _mm256_cmp_pd(edgeValuesLo[1], zero, _CMP_GE_OQ)), _mm256_cmp_pd(edgeValuesLo[2], zero, _CMP_GE_OQ));
+			const __m256d insideHi = _mm256_and_pd(_mm256_and_pd(_mm256_cmp_pd(edgeValuesHi[0], zero, _CMP_GE_OQ), _mm256_cmp_pd(edgeValuesHi[1], zero, _CMP_GE_OQ)), _mm256_cmp_pd(edgeValuesHi[2], zero, _CMP_GE_OQ));
+			uint32 coverage = (uint32)(_mm256_movemask_pd(insideLo) | (_mm256_movemask_pd(insideHi) << 4));
+
+			const int32 remaining = input.NumPixels - baseIndex;
+			if (remaining < laneCount)
+			{
+				coverage &= (1u << remaining) - 1;
+			}
+
+			if (coverage != 0)
+			{
+				coverageMask |= (uint64)coverage << baseIndex;
+
+				__m256 barycentric[3];
+				for (int32 edgeIndex = 0; edgeIndex != 3; ++edgeIndex)
+				{
+					const __m128 lo = _mm256_cvtpd_ps(_mm256_add_pd(edgeValuesLo[edgeIndex], biases[edgeIndex]));
+					const __m128 hi = _mm256_cvtpd_ps(_mm256_add_pd(edgeValuesHi[edgeIndex], biases[edgeIndex]));
+					barycentric[edgeIndex] = _mm256_mul_ps(_mm256_insertf128_ps(_mm256_castps128_ps256(lo), hi, 1), invArea);
+					_mm256_store_ps(output.Barycentric[edgeIndex] + baseIndex, barycentric[edgeIndex]);
+				}
+
+				const __m256 depth = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(vertexDepths[0], barycentric[0]), _mm256_mul_ps(vertexDepths[1], barycentric[1])), _mm256_mul_ps(vertexDepths[2], barycentric[2]));
+				const __m256 depthBufferValue = _mm256_sub_ps(one, _mm256_add_ps(_mm256_mul_ps(depth, half), half));
+				_mm256_store_ps(output.DepthBufferValue + baseIndex, depthBufferValue);
+
+				if (input.DepthRow != nullptr)
+				{
+					__m256 stored;
+					if (remaining >= laneCount)
+					{
+						stored = _mm256_loadu_ps(input.DepthRow + baseIndex);
+					}
+					else
+					{
+						alignas(32) float padded[laneCount] = {};
+						for (int32 index = 0; index != remaining; ++index)
+						{
+							padded[index] = input.DepthRow[baseIndex + index];
+						}
+						stored = _mm256_load_ps(padded);
+					}
+
+					const __m256 rejected = _mm256_cmp_ps(stored, depthBufferValue, _CMP_GT_OQ);
+					coverage &= ~(uint32)_mm256_movemask_ps(rejected);
+				}
+
+				mask |= (uint64)coverage << baseIndex;
+			}
+
+			for (int32 edgeIndex = 0; edgeIndex != 3; ++edgeIndex)
+			{
+				edgeValuesLo[edgeIndex] = _mm256_add_pd(edgeValuesLo[edgeIndex], edgeSteps[edgeIndex]);
+				edgeValuesHi[edgeIndex] = _mm256_add_pd(edgeValuesHi[edgeIndex], edgeSteps[edgeIndex]);
+			}
+		}
+		output.CoverageMask = coverageMask;
+		return mask;
+	}
+#endif
+}
+
+TV::Renderer::RasterSpanFunction TV::Renderer::GetRasterSpanFunction(SimdLevel simdLevel)
+{
+#if TV_SIMD_X86
+	switch (GetSupportedSimdLevel(simdLevel))
+	{
+	case SimdLevel::AVX2:
+		return &RasterSpan_AVX2;
+	case SimdLevel::SSE2:
+		return &RasterSpan_SSE2;
+	default:
+		break;
+	}
+#endif
+	return &RasterSpan_Scalar;
+}
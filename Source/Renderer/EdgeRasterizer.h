@@ -0,0 +1,80 @@
+#pragma once
+
+#include "../Maths/Types.h"
+#include "../Maths/Vec2.h"
+#include "../Maths/Vec3.h"
+#include "../Maths/CpuFeatures.h"
+
+namespace TV
+{
+	namespace Renderer
+	{
+		using namespace Maths;
+
+		// Edge equations of a screen space triangle in fixed point, so they can be stepped exactly.
+		// Edge N is opposite vertex N, and is positive on the inside of the triangle whatever the winding
+		struct TriangleEdges
+		{
+			static constexpr int32 SubPixelBits = 8;
+
+			// vertices further than this from the origin would overflow the fixed point maths
+			static constexpr float MaxCoordinate = 16384.f;
+
+			int64 StepX[3]; // change of edge value for one pixel step in x
+			int64 StepY[3]; // change of edge value for one pixel step in y
+			int64 Origin[3]; // biased edge value at pixel (0,0)
+			int64 Bias[3]; // top-left fill rule, 0 for top and left edges, 1 otherwise
+			float InvArea = 0.f;
+
+			static bool IsInRange(const Vec2f screenPositions[3]);
+
+			// position rounded to the sub pixel grid, as the edge equations see it
+			static Vec2f GetSnapped(const Vec2f& screenPosition)
+			{
+				constexpr float subPixelScale = (float)(1 << SubPixelBits);
+				return Vec2f(GetRoundToInt(screenPosition.X * subPixelScale) / subPixelScale, GetRoundToInt(screenPosition.Y * subPixelScale) / subPixelScale);
+			}
+
+			// returns false if the triangle is degenerate
+			bool Setup(const Vec2f screenPositions[3]);
+
+			// biased edge value at a pixel, the pixel is covered if all three are >= 0
+			int64 Evaluate(int32 edgeIndex, const Vec2i& point) const
+			{
+				return Origin[edgeIndex] + StepX[edgeIndex] * point.X + StepY[edgeIndex] * point.Y;
+			}
+
+			Vec3f GetBarycentric(const int64 edgeValues[3]) const
+			{
+				return Vec3f(
+					(float)(edgeValues[0] + Bias[0]) * InvArea,
+					(float)(edgeValues[1] + Bias[1]) * InvArea,
+					(float)(edgeValues[2] + Bias[2]) * InvArea);
+			}
+		};
+
+		// Evaluates coverage, barycentrics and the depth test for a horizontal run of pixels in one go
+		struct RasterSpanInput
+		{
+			static constexpr int32 MaxPixels = 64;
+
+			const TriangleEdges* Edges = nullptr;
+			int64 EdgeValues[3] = {}; // biased edge values at the first pixel of the span
+			int32 NumPixels = 0; // must be <= MaxPixels
+			float VertexDepths[3] = {}; // normalised device coordinate z of each vertex
+			const float* DepthRow = nullptr; // depth buffer values under the span, nullptr to skip the depth test
+		};
+
+		struct RasterSpanOutput
+		{
+			alignas(32) float Barycentric[3][RasterSpanInput::MaxPixels];
+			alignas(32) float DepthBufferValue[RasterSpanInput::MaxPixels]; // remapped such that 0 = far clip, 1 = near clip
+			uint64 CoverageMask = 0; // bit N set if pixel N is covered, whether or not it passed the depth test
+		};
+
+		// returns a mask with bit N set if pixel N is covered and passes the depth test, output is only written for those pixels
+		using RasterSpanFunction = uint64(*)(const RasterSpanInput& input, RasterSpanOutput& output);
+
+		RasterSpanFunction GetRasterSpanFunction(SimdLevel simdLevel);
+	}
+}
@@ -0,0 +1,140 @@
+#include "FrameArena.h"
+
+#include <new>
+
+TV::Renderer::FrameArena::FrameArena(size_t initialCapacity)
+{
+	if (initialCapacity > 0)
+	{
+		AddBlock(initialCapacity);
+	}
+}
+
+TV::Renderer::FrameArena::~FrameArena()
+{
+	FreeBlocks();
+}
+
+void* TV::Renderer::FrameArena::Allocate(size_t size, size_t alignment)
+{
+	check(alignment != 0 && (alignment & (alignment - 1)) == 0 && alignment <= BlockAlignment);
+
+	size_t start = (Offset + alignment - 1) & ~(alignment - 1);
+	if (!Blocks.empty() && start + size <= Blocks.back().Size)
+	{
+		Offset = start + size;
+	}
+	else
+	{
+		// blocks are aligned for anything, so a new one starts at the beginning
+		AddBlock(size);
+		start = 0;
+		Offset = size;
+	}
+
+	const size_t used = UsedInFullBlocks + Offset;
+	HighWaterMark = used > HighWaterMark ? used : HighWaterMark;
+	return Blocks.back().Memory + start;
+}
+
+void TV::Renderer::FrameArena::Reset()
+{
+	for (const std::unique_ptr<FrameArena>& threadArena : ThreadArenas)
+	{
+		threadArena->Reset();
+	}
+
+	// the last frame didn't fit, so swap the blocks for one that would have held it
+	if (Blocks.size() > 1)
+	{
+		FreeBlocks();
+		AddBlock(HighWaterMark);
+	}
+	Offset = 0;
+	UsedInFullBlocks = 0;
+}
+
+void TV::Renderer::FrameArena::SetNumThreadArenas(int32 numThreads)
+{
+	while ((int32)ThreadArenas.size() < numThreads)
+	{
+		ThreadArenas.push_back(std::make_unique<FrameArena>());
+	}
+}
+
+size_t TV::Renderer::FrameArena::GetBytesUsed() const
+{
+	size_t bytes = Blocks.empty() ? 0 : UsedInFullBlocks + Offset;
+	for (const std::unique_ptr<FrameArena>& threadArena : ThreadArenas)
+	{
+		bytes += threadArena->GetBytesUsed();
+	}
+	return bytes;
+}
+
+size_t TV::Renderer::FrameArena::GetHighWaterMark() const
+{
+	size_t bytes = HighWaterMark;
+	for (const std::unique_ptr<FrameArena>& threadArena : ThreadArenas)
+	{
+		bytes += threadArena->GetHighWaterMark();
+	}
+	return bytes;
+}
+
+size_t TV::Renderer::FrameArena::GetCapacity() const
+{
+	size_t bytes = 0;
+	for (const Block& block : Blocks)
+	{
+		bytes += block.Size;
+	}
+	for (const std::unique_ptr<FrameArena>& threadArena : ThreadArenas)
+	{
+		bytes += threadArena->GetCapacity();
+	}
+	return bytes;
+}
+
+TV::int32 TV::Renderer::FrameArena::GetNumBlockAllocations() const
+{
+	int32 count = NumBlockAllocations;
+	for (const std::unique_ptr<FrameArena>& threadArena : ThreadArenas)
+	{
+		count += threadArena->GetNumBlockAllocations();
+	}
+	return count;
+}
+
+void TV::Renderer::FrameArena::AddBlock(size_t minSize)
+{
+	// at least double the capacity each time, so a frame which keeps growing only needs a few blocks
+	size_t size = 0;
+	for (const Block& block : Blocks)
+	{
+		size += block.Size;
+	}
+	size = size > MinBlockSize ? size : MinBlockSize;
+	size = size > minSize ? size : minSize;
+	size = (size + BlockAlignment - 1) & ~(BlockAlignment - 1);
+
+	if (!Blocks.empty())
+	{
+		UsedInFullBlocks += Blocks.back().Size;
+	}
+
+	Block block;
+	block.Memory = (std::byte*)::operator new(size, std::align_val_t(BlockAlignment));
+	block.Size = size;
+	Blocks.push_back(block);
+	++NumBlockAllocations;
+}
+
+void TV::Renderer::FrameArena::FreeBlocks()
+{
+	for (const Block& block : Blocks)
+	{
+		::operator delete(block.Memory, std::align_val_t(BlockAlignment));
+	}
+	Blocks.clear();
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include "../Maths/Assert.h"
+#include "../Maths/Types.h"
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace TV
+{
+	namespace Renderer
+	{
+		// Linear allocator for memory which only lives until the end of a frame, or of a draw when the rasterizer owns it.
+		// Allocation bumps an offset and nothing is freed individually; Reset frees everything at once.
+		// When a frame needs more than the current block, extra blocks are allocated and at the next Reset replaced by one block
+		// large enough for the most any frame has used, so after the first frame or two a steady workload allocates nothing from the heap.
+		// Not thread safe: threads allocate from their own thread arenas
+		class FrameArena
+		{
+		public:
+			static constexpr size_t MinBlockSize = 64 * 1024;
+			static constexpr size_t BlockAlignment = 64; // a cache line, and enough for any simd load
+
+			explicit FrameArena(size_t initialCapacity = 0);
+			~FrameArena();
+
+			// Scratch memory isn't shared, so copies start empty. This lets objects owning an arena, like rasterizers, be copied
+			FrameArena(const FrameArena&) : FrameArena() {}
+			FrameArena& operator = (const FrameArena&) { return *this; }
+
+			// uninitialised memory, valid until the next Reset
+			void* Allocate(size_t size, size_t alignment);
+
+			// an uninitialised array, for types which need no construction or destruction
+			template<class T>
+			T* Allocate(int32 count)
+			{
+				static_assert(std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>, "arena memory is never destructed");
+				check(count >= 0);
+				return (T*)Allocate(sizeof(T) * count, alignof(T));
+			}
+
+			// frees everything allocated since the last reset, including from the thread arenas
+			void Reset();
+
+			// Makes sure there are thread arenas for threads [0, numThreads), e.g. one per thread of a thread pool.
+			// Must not be called while any thread is using them
+			void SetNumThreadArenas(int32 numThreads);
+			FrameArena& GetThreadArena(int32 threadIndex)
+			{
+				check(threadIndex >= 0 && threadIndex < (int32)ThreadArenas.size());
+				return *ThreadArenas[threadIndex];
+			}
+
+			// These include the thread arenas. The high water mark is the most used between two resets, which is the capacity
+			// to construct with to never allocate more
+			size_t GetBytesUsed() const;
+			size_t GetHighWaterMark() const;
+			size_t GetCapacity() const;
+			int32 GetNumBlockAllocations() const; // heap allocations made since construction
+
+		private:
+			struct Block
+			{
+				std::byte* Memory = nullptr;
+				size_t Size = 0;
+			};
+
+			void AddBlock(size_t minSize);
+			void FreeBlocks();
+
+			std::vector<Block> Blocks; // allocation is from the last
+			size_t Offset = 0; // into the last block
+			size_t UsedInFullBlocks = 0; // by blocks before the last, including what was left unused at their ends
+			size_t HighWaterMark = 0;
+			int32 NumBlockAllocations = 0;
+
+			std::vector<std::unique_ptr<FrameArena>> ThreadArenas;
+		};
+
+		// Growable array in a frame arena. Growing copies the elements to a new allocation twice the size and abandons the old one,
+		// so it uses at most twice the memory of a correctly reserved array, and pointers to elements are invalidated by Add
+		template<class T>
+		class TArenaArray
+		{
+		public:
+			explicit TArenaArray(FrameArena& arena, int32 initialCapacity = 0) : Arena(&arena)
+			{
+				Reserve(initialCapacity);
+			}
+
+			void Reserve(int32 capacity)
+			{
+				if (capacity <= Capacity)
+				{
+					return;
+				}
+				T* const newData = Arena->Allocate<T>(capacity);
+				if (Num != 0)
+				{
+					std::memcpy((void*)newData, (const void*)Data, sizeof(T) * Num);
+				}
+				Data = newData;
+				Capacity = capacity;
+			}
+
+			T& Add(const T& value)
+			{
+				if (Num == Capacity)
+				{
+					Reserve(Capacity < 16 ? 16 : Capacity * 2);
+				}
+				Data[Num] = value;
+				return Data[Num++];
+			}
+
+			int32 GetNum() const { return Num; }
+			bool IsEmpty() const { return Num == 0; }
+
+			T& operator [] (int32 index) { check(index >= 0 && index < Num); return Data[index]; }
+			const T& operator [] (int32 index) const { check(index >= 0 && index < Num); return Data[index]; }
+
+			T* begin() { return Data; }
+			T* end() { return Data + Num; }
+			const T* begin() const { return Data; }
+			const T* end() const { return Data + Num; }
+
+		private:
+			FrameArena* Arena = nullptr;
+			T* Data = nullptr;
+			int32 Num = 0;
+			int32 Capacity = 0;
+		};
+	}
+}
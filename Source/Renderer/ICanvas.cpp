@@ -0,0 +1,97 @@
+#include "ICanvas.h"
+
+#include <algorithm>
+#include <cstring>
+
+void TV::Renderer::ICanvas::SetMemory(uint8* memory, const Vec2i& size, int32 stride, PixelFormat format)
+{
+	if (memory == nullptr || GetBytesPerPixel(format) == 0)
+	{
+		Memory = nullptr;
+		MemorySize = Vec2i();
+		Stride = 0;
+		BytesPerPixel = 0;
+		Format = PixelFormat::Unknown;
+		return;
+	}
+
+	Memory = memory;
+	MemorySize = size;
+	Stride = stride;
+	BytesPerPixel = GetBytesPerPixel(format);
+	Format = format;
+}
+
+void TV::Renderer::ICanvas::WriteSpan(const Vec2i& start, const Colour* colours, int32 count)
+{
+	if (Memory == nullptr)
+	{
+		for (int32 index = 0; index != count; ++index)
+		{
+			SetPixel(Vec2i(start.X + index, start.Y), colours[index]);
+		}
+		return;
+	}
+
+	if ((uint32)start.Y >= (uint32)MemorySize.Y)
+	{
+		return;
+	}
+	const int32 first = GetMax(0, -start.X);
+	const int32 last = GetMin(count, MemorySize.X - start.X);
+
+	uint8* pixel = GetRowData(start.Y) + (start.X + first) * BytesPerPixel;
+	for (int32 index = first; index < last; ++index, pixel += BytesPerPixel)
+	{
+		StorePixel(pixel, colours[index]);
+	}
+}
+
+void TV::Renderer::ICanvas::FillSpan(const Vec2i& start, int32 count, const Colour& colour)
+{
+	if (Memory == nullptr)
+	{
+		for (int32 index = 0; index != count; ++index)
+		{
+			SetPixel(Vec2i(start.X + index, start.Y), colour);
+		}
+		return;
+	}
+
+	if ((uint32)start.Y >= (uint32)MemorySize.Y)
+	{
+		return;
+	}
+	const int32 first = GetMax(start.X, 0);
+	const int32 last = GetMin(start.X + count, MemorySize.X);
+	if (first >= last)
+	{
+		return;
+	}
+
+	uint8* const row = GetRowData(start.Y);
+	switch (BytesPerPixel)
+	{
+	case 4:
+		std::fill((uint32*)row + first, (uint32*)row + last, colour.PackedData);
+		break;
+	case 1:
+		std::memset(row + first, colour.Raw[0], last - first);
+		break;
+	default:
+		for (uint8* pixel = row + first * BytesPerPixel; pixel != row + last * BytesPerPixel; pixel += BytesPerPixel)
+		{
+			StorePixel(pixel, colour);
+		}
+		break;
+	}
+}
+
+void TV::Renderer::ICanvas::Fill(const Colour& colour)
+{
+	const Vec2i size = GetSize();
+	for (int32 y = 0; y != size.Y; ++y)
+	{
+		FillSpan(Vec2i(0, y), size.X, colour);
+	}
+}
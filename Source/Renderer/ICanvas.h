@@ -9,6 +9,26 @@ namespace TV
 	{
 		using namespace Maths;
 
+		// memory layout of a pixel, in byte order. Pixels hold the leading bytes of Colour::Raw
+		enum class PixelFormat
+		{
+			Unknown,
+			Grayscale8,
+			BGR8,
+			BGRA8,
+		};
+
+		inline int32 GetBytesPerPixel(PixelFormat format)
+		{
+			switch (format)
+			{
+			case PixelFormat::Grayscale8: return 1;
+			case PixelFormat::BGR8: return 3;
+			case PixelFormat::BGRA8: return 4;
+			default: return 0;
+			}
+		}
+
 		class ICanvas
 		{
 		public:
@@ -19,6 +39,86 @@ namespace TV
 			virtual Colour GetPixel(const Vec2i& coord) const = 0;
 
 			float GetAspectRatio() const { return GetSize().X / (float)GetSize().Y; }
+
+			// direct memory access, only available if the canvas has exposed its memory via SetMemory
+			bool HasDirectAccess() const { return Memory != nullptr; }
+			uint8* GetRowData(int32 y) const { return Memory != nullptr ? Memory + (size_t)y * Stride : nullptr; }
+			int32 GetStride() const { return Stride; }
+			PixelFormat GetPixelFormat() const { return Format; }
+
+			// Bulk writes which go straight to memory when possible, falling back to SetPixel otherwise.
+			// Pixels outside the canvas are ignored
+			void WritePixel(const Vec2i& coord, const Colour& colour)
+			{
+				if (Memory == nullptr)
+				{
+					SetPixel(coord, colour);
+					return;
+				}
+				if ((uint32)coord.X >= (uint32)MemorySize.X || (uint32)coord.Y >= (uint32)MemorySize.Y)
+				{
+					return;
+				}
+				StorePixel(GetRowData(coord.Y) + coord.X * BytesPerPixel, colour);
+			}
+			// reads straight from memory when possible, for blending. Channels the format doesn't store read as zero
+			Colour ReadPixel(const Vec2i& coord) const
+			{
+				if (Memory == nullptr)
+				{
+					return GetPixel(coord);
+				}
+				if ((uint32)coord.X >= (uint32)MemorySize.X || (uint32)coord.Y >= (uint32)MemorySize.Y)
+				{
+					return Colour();
+				}
+				return LoadPixel(GetRowData(coord.Y) + coord.X * BytesPerPixel);
+			}
+			void WriteSpan(const Vec2i& start, const Colour* colours, int32 count);
+			void FillSpan(const Vec2i& start, int32 count, const Colour& colour);
+			void Fill(const Colour& colour);
+
+		protected:
+			// to be called by canvases which own their pixels whenever the memory changes, nullptr to disable direct access
+			void SetMemory(uint8* memory, const Vec2i& size, int32 stride, PixelFormat format);
+
+		private:
+			void StorePixel(uint8* pixel, const Colour& colour) const
+			{
+				switch (BytesPerPixel)
+				{
+				case 4:
+					*(uint32*)pixel = colour.PackedData;
+					break;
+				case 3:
+					pixel[0] = colour.Raw[0];
+					pixel[1] = colour.Raw[1];
+					pixel[2] = colour.Raw[2];
+					break;
+				default:
+					pixel[0] = colour.Raw[0];
+					break;
+				}
+			}
+
+			Colour LoadPixel(const uint8* pixel) const
+			{
+				switch (BytesPerPixel)
+				{
+				case 4:
+					return Colour(*(const uint32*)pixel);
+				case 3:
+					return Colour(pixel, 3);
+				default:
+					return Colour(pixel, 1);
+				}
+			}
+
+			uint8* Memory = nullptr;
+			Vec2i MemorySize;
+			int32 Stride = 0; // in bytes
+			int32 BytesPerPixel = 0;
+			PixelFormat Format = PixelFormat::Unknown;
 		};
 	}
-}
\ No newline at end of file
+}
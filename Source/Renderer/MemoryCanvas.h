@@ -0,0 +1,53 @@
+#pragma once
+
+#include "../Maths/Assert.h"
+#include "ICanvas.h"
+
+#include <vector>
+
+namespace TV
+{
+	namespace Renderer
+	{
+		using namespace Maths;
+
+		// canvas which is just BGRA8 pixels in memory, for rendering with no window or image behind it
+		class MemoryCanvas : public ICanvas
+		{
+		public:
+			explicit MemoryCanvas(const Vec2i& size)
+				: Size(size)
+				, Pixels((size_t)size.X * size.Y)
+			{
+				SetMemory((uint8*)Pixels.data(), Size, Size.X * (int32)sizeof(uint32), PixelFormat::BGRA8);
+			}
+
+			MemoryCanvas(const MemoryCanvas&) = delete;
+			MemoryCanvas& operator = (const MemoryCanvas&) = delete;
+
+			virtual Vec2i GetSize() const override { return Size; }
+			virtual void SetPixel(const Vec2i& coord, const Colour& colour) override
+			{
+				ValidatePoint(coord);
+				Pixels[coord.X + (size_t)coord.Y * Size.X] = colour.PackedData;
+			}
+			virtual Colour GetPixel(const Vec2i& coord) const override
+			{
+				ValidatePoint(coord);
+				return Colour(Pixels[coord.X + (size_t)coord.Y * Size.X]);
+			}
+
+		private:
+			void ValidatePoint(const Vec2i& point) const
+			{
+				check(point.X >= 0);
+				check(point.Y >= 0);
+				check(point.X < Size.X);
+				check(point.Y < Size.Y);
+			}
+
+			const Vec2i Size;
+			std::vector<uint32> Pixels;
+		};
+	}
+}
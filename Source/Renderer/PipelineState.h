@@ -0,0 +1,100 @@
+#pragma once
+
+#include "../Maths/Types.h"
+#include "../Maths/Colour.h"
+#include "../Maths/Assert.h"
+#include "ICanvas.h"
+
+#include <utility>
+
+namespace TV
+{
+	namespace Renderer
+	{
+		using namespace Maths;
+
+		enum class CullMode
+		{
+			None,
+			Back,
+			Front,
+		};
+
+		enum class BlendMode
+		{
+			Opaque, // fragments replace what is in the canvas
+			AlphaBlend, // fragments are blended over what is in the canvas by their alpha
+		};
+
+		// Fixed function state of a draw. Draws are compiled separately for every combination of the per pixel state, so pixels don't branch on it.
+		// Culling is decided once per triangle, so it is checked as it goes and doesn't multiply the number of instantiations
+		struct PipelineState
+		{
+			bool bDepthTest = true; // both depth flags need a depth buffer in the render context, and are off without one
+			bool bDepthWrite = true;
+			bool bAlphaDiscard = true; // fragments the shader outputs zero alpha for are dropped
+			BlendMode Blend = BlendMode::Opaque;
+			CullMode Culling = CullMode::None;
+
+			bool operator == (const PipelineState& other) const = default;
+		};
+
+		// every combination of per pixel state is numbered, so they can all be instantiated
+		constexpr int32 NumPipelineStates = 2 * 2 * 2 * 2;
+
+		constexpr int32 GetPipelineStateIndex(const PipelineState& state)
+		{
+			return (int32)state.bDepthTest | ((int32)state.bDepthWrite << 1) | ((int32)state.bAlphaDiscard << 2) | ((int32)state.Blend << 3);
+		}
+
+		constexpr PipelineState GetPipelineState(int32 index)
+		{
+			PipelineState state;
+			state.bDepthTest = (index & 1) != 0;
+			state.bDepthWrite = (index & 2) != 0;
+			state.bAlphaDiscard = (index & 4) != 0;
+			state.Blend = (BlendMode)(index >> 3);
+			return state;
+		}
+
+		static_assert(GetPipelineStateIndex(GetPipelineState(NumPipelineStates - 1)) == NumPipelineStates - 1);
+
+		// calls function.template operator()<State>() with the compile time equivalent of state's per pixel state
+		template<class TFunction>
+		void DispatchPipelineState(const PipelineState& state, TFunction&& function)
+		{
+			const int32 index = GetPipelineStateIndex(state);
+			check(index >= 0 && index < NumPipelineStates);
+			[&]<int32... Indices>(std::integer_sequence<int32, Indices...>)
+			{
+				(void)((index == Indices && (function.template operator()<GetPipelineState(Indices)>(), true)) || ...);
+			}(std::make_integer_sequence<int32, NumPipelineStates>());
+		}
+
+		// source over destination, weighted by the source alpha
+		inline Colour BlendAlpha(const Colour& source, const Colour& destination)
+		{
+			const uint32 alpha = source.A;
+			Colour blended;
+			for (int32 channel = 0; channel != 3; ++channel)
+			{
+				blended.Raw[channel] = (uint8)((source.Raw[channel] * alpha + destination.Raw[channel] * (255 - alpha) + 127) / 255);
+			}
+			blended.A = (uint8)(alpha + (destination.A * (255 - alpha) + 127) / 255);
+			return blended;
+		}
+
+		template<BlendMode Blend>
+		void WriteFragment(ICanvas& canvas, const Vec2i& point, const Colour& colour)
+		{
+			if constexpr (Blend == BlendMode::AlphaBlend)
+			{
+				canvas.WritePixel(point, BlendAlpha(colour, canvas.ReadPixel(point)));
+			}
+			else
+			{
+				canvas.WritePixel(point, colour);
+			}
+		}
+	}
+}
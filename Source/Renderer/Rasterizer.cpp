@@ -11,4 +11,9 @@ void TV::Renderer::RenderContext::Validate() const
 	{
 		check(DepthBuffer->GetSize() == Canvas->GetSize());
 	}
+	if (VisibilityBuffer != nullptr)
+	{
+		check(DepthBuffer != nullptr);
+		check(VisibilityBuffer->GetSize() == Canvas->GetSize());
+	}
 }
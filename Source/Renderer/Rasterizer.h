@@ -7,8 +7,18 @@
 #include "../Maths/Geometry.h"
 #include "ICanvas.h"
 #include "DepthBuffer.h"
+#include "Clipping.h"
 #include "Drawing.h"
+#include "DrawStats.h"
+#include "EdgeRasterizer.h"
+#include "FrameArena.h"
+#include "PipelineState.h"
+#include "ThreadPool.h"
+#include "Varyings.h"
+#include "VisibilityBuffer.h"
 #include "../Model/Model.h"
+#include <algorithm>
+#include <bit>
 #include <vector>
 
 namespace TV
@@ -19,16 +29,62 @@ namespace TV
 
 		class ICanvas;
 		class DepthBuffer;
+		class ThreadPool;
+		class VisibilityBuffer;
 
 		struct RenderContext
 		{
-			DepthBuffer* DepthBuffer = nullptr;
+			Renderer::DepthBuffer* DepthBuffer = nullptr;
 			ICanvas* Canvas = nullptr;
+			Renderer::ThreadPool* ThreadPool = nullptr; // optional, if set triangles are binned into screen tiles which are rasterized in parallel
+
+			// optional, if set DrawModel resolves visibility for all triangles first and then shades each visible pixel once.
+			// Requires a depth buffer with depth test and write enabled. Only the nearest fragment of each pixel is shaded,
+			// so blending is against the canvas as it was before the draw
+			Renderer::VisibilityBuffer* VisibilityBuffer = nullptr;
+
+			// Optional, scratch memory for draws: transformed and clipped vertices, triangle setups and tile bins. Its owner resets it,
+			// usually once a frame, and not during a draw. Without one a rasterizer uses its own, reset at the start of each draw
+			FrameArena* Arena = nullptr;
 
 			bool IsValid() const { return Canvas != nullptr; }
 			void Validate() const;
 		};
 
+		enum class RasterizationMethod
+		{
+			Barycentric, // solves barycentric coordinates per pixel, reference implementation
+			EdgeFunction, // sets up fixed point edge equations once per triangle and steps them per pixel
+		};
+
+		// winding of front facing triangles, in normalised device coordinates
+		enum class Winding
+		{
+			CounterClockwise,
+			Clockwise,
+		};
+
+		// Screen space rates of change of a fragment's interpolated vertex outputs, for shaders which pick texture mip levels.
+		// Fragment shaders receive these if they take them as a third parameter
+		template<class TVertexOutput>
+		struct TFragmentDerivatives
+		{
+			const TVertexOutput* Vertices[3] = {};
+			Vec3f BarycentricDX; // change in the perspective correct barycentric coordinates at the fragment for a step of one pixel in x
+			Vec3f BarycentricDY;
+
+			template<class T>
+			T GetDDX(T TVertexOutput::* member) const
+			{
+				return ComputeValueFromBarycentric(BarycentricDX, Vertices[0]->*member, Vertices[1]->*member, Vertices[2]->*member);
+			}
+			template<class T>
+			T GetDDY(T TVertexOutput::* member) const
+			{
+				return ComputeValueFromBarycentric(BarycentricDY, Vertices[0]->*member, Vertices[1]->*member, Vertices[2]->*member);
+			}
+		};
+
 		class IRasterizer
 		{
 		public:
@@ -36,9 +92,30 @@ namespace TV
 			Matrix4x4f ViewMatrix;
 			Matrix4x4f ProjectionMatrix;
 
+			// derived from the matrices above at the start of each draw
+			Matrix4x4f ModelViewMatrix;
+			Matrix4x4f ModelViewProjectionMatrix;
+
+			int32 TileSize = 64; // size in pixels of the screen tiles used when rendering with a thread pool
+			RasterizationMethod Method = RasterizationMethod::EdgeFunction;
+			SimdLevel MaxSimdLevel = SimdLevel::AVX2; // the edge function path uses the best level supported by the cpu up to this
+			bool bHierarchicalDepthTest = true; // skip triangles and depth buffer tiles which are entirely occluded before doing per pixel work
+			PipelineState Pipeline;
+			Winding FrontFaceWinding = Winding::CounterClockwise;
+
+			DrawStats Stats; // reset by each draw
+
 		public:
-			virtual void DrawModel(const Model& model, const RenderContext& context) = 0;
-			virtual void DrawModelWireframe(const Model& model, const RenderContext& context, const Colour& colour) = 0;
+			// both return Stats
+			virtual const DrawStats& DrawModel(const Model& model, const RenderContext& context) = 0;
+			virtual const DrawStats& DrawModelWireframe(const Model& model, const RenderContext& context, const Colour& colour) = 0;
+
+		protected:
+			void UpdateDerivedMatrices()
+			{
+				ModelViewMatrix = ViewMatrix * ModelMatrix;
+				ModelViewProjectionMatrix = ProjectionMatrix * ModelViewMatrix;
+			}
 		};
 
 		template<class TShader>
@@ -46,80 +123,513 @@ namespace TV
 		{
 		public:
 			typedef typename TShader::VertexOutput VertexOutput;
+			typedef TFragmentDerivatives<VertexOutput> FragmentDerivatives;
+
+			// Shaders may declare Varyings, a TVaryings listing the vertex output members their fragment shader uses, which are then interpolated
+			// from plane equations set up once per triangle. Otherwise the shader's Interpolate is called for each fragment.
+			// Either way interpolation is perspective correct, and Interpolate must blend members linearly as it is also used for clipping
+			static constexpr bool bHasVaryings = requires { typename TShader::Varyings; };
+
+			typedef typename TShaderAttributePlanes<TShader>::Type AttributePlanes;
 
-			virtual void DrawModel(const Model& model, const RenderContext& context) final;
-			virtual void DrawModelWireframe(const Model& model, const RenderContext& context, const Colour& colour) final;
+			virtual const DrawStats& DrawModel(const Model& model, const RenderContext& context) final;
+			virtual const DrawStats& DrawModelWireframe(const Model& model, const RenderContext& context, const Colour& colour) final;
 
 			void DrawTriangle(const RenderContext& context, const VertexOutput& vertexA, const VertexOutput& vertexB, const VertexOutput& vertexC);
+
+		protected:
+			struct TriangleSetup
+			{
+				const VertexOutput* Vertices[3];
+				Vec3f NormalisedDeviceCoordPositions[3];
+				Vec2f ScreenPositions[3];
+
+				// inclusive pixel bounds, clamped to the canvas
+				Vec2i Min;
+				Vec2i Max;
+
+				TriangleEdges Edges;
+				bool bUseEdges = false;
+
+				// nearest and farthest depth buffer values of any point on the triangle, for hierarchical depth rejection and acceptance
+				float MaxDepthBufferValue = 0.f;
+				float MinDepthBufferValue = 0.f;
+
+				// index into the model, for writing to the visibility buffer
+				int32 TriangleIndex = VisibilityBuffer::NoTriangle;
+
+				// for triangles produced by clipping, the barycentric coordinates of each vertex on the model triangle
+				bool bClipped = false;
+				Vec3f SourceWeights[3];
+
+				// clip space w of each vertex and its reciprocal, for perspective correction
+				Vec3f VertexW;
+				Vec3f VertexInvW;
+
+				// screen space barycentrics change linearly, so their derivatives are the same for every pixel. Multiplied by each vertex's 1/w
+				Vec3f InvWBarycentricDX;
+				Vec3f InvWBarycentricDY;
+
+				AttributePlanes Planes;
+			};
+
+			// Draws are specialised on their pipeline state, and on whether they write to a visibility buffer or shade directly.
+			// DrawModel resolves the state against the render context and dispatches to the matching instantiation
+			template<PipelineState State, bool bVisibilityBuffer>
+			void DrawModelSpecialised(const Model& model, const RenderContext& context);
+
+			// projects the triangle to screen space, returns false if it is culled or doesn't touch any pixels
+			bool SetupTriangle(const RenderContext& context, const VertexOutput& vertexA, const VertexOutput& vertexB, const VertexOutput& vertexC, TriangleSetup& setup, DrawStats& stats) const;
+
+			// clips the triangle to the view and calls onSetup with each resulting triangle which touches any pixels.
+			// Vertices created by clipping are allocated from arena, so the setups are valid until it is reset
+			template<class TFunction>
+			void ClipAndSetupTriangle(const RenderContext& context, const VertexOutput& vertexA, const VertexOutput& vertexB, const VertexOutput& vertexC, FrameArena& arena, DrawStats& stats, TFunction&& onSetup) const;
+
+			// rasterizes the part of the triangle within [clipMin, clipMax] (inclusive)
+			template<PipelineState State, bool bVisibilityBuffer>
+			void RasterizeTriangle(const RenderContext& context, const TriangleSetup& setup, const Vec2i& clipMin, const Vec2i& clipMax);
+			template<PipelineState State, bool bVisibilityBuffer>
+			void RasterizeTriangle_Barycentric(const RenderContext& context, const TriangleSetup& setup, const Vec2i& min, const Vec2i& max, DrawStats& stats);
+			template<PipelineState State, bool bVisibilityBuffer>
+			void RasterizeTriangle_EdgeFunction(const RenderContext& context, const TriangleSetup& setup, const Vec2i& min, const Vec2i& max, DrawStats& stats);
+
+			// depth tests, shades and writes a single covered pixel, moving timer on to the stage it is in
+			template<PipelineState State, bool bVisibilityBuffer>
+			void ShadePixel(const RenderContext& context, const TriangleSetup& setup, const Vec2i& point2D, const Vec3f& barycentric, DrawStats& stats, DrawStageTimer& timer);
+
+			static constexpr bool bFragmentShaderTakesDerivatives = requires(const TShader& shader, const IRasterizer& rasterizer, const VertexOutput& input, const FragmentDerivatives& derivatives)
+			{
+				shader.FragmentShader(rasterizer, input, derivatives);
+			};
+
+			Colour RunFragmentShader(const VertexOutput& input, const FragmentDerivatives& derivatives) const
+			{
+				if constexpr (bFragmentShaderTakesDerivatives)
+				{
+					return TShader::FragmentShader(*this, input, derivatives);
+				}
+				else
+				{
+					return TShader::FragmentShader(*this, input);
+				}
+			}
+
+			// shades and writes a pixel which has already passed the depth test, or records it in the visibility buffer
+			template<PipelineState State, bool bVisibilityBuffer>
+			void ShadeFragment(const RenderContext& context, const TriangleSetup& setup, const Vec2i& point2D, const Vec3f& barycentric, float depthBufferVal, DrawStats& stats);
+
+			// Vertex outputs are shaded on first use by a batch of triangles and kept in a buffer indexed like the model's vertices,
+			// so each vertex is shaded at most once per draw. The buffer is allocated from the draw's arena, the rest is reused from one draw to the next
+			struct VertexCache
+			{
+				VertexOutput* Outputs = nullptr;
+				std::vector<uint32> Stamps; // a vertex has been shaded this draw if its stamp matches CurrentStamp
+				uint32 CurrentStamp = 0;
+				std::vector<int32> Pending; // vertices to shade for the current batch
+			};
+			VertexCache PostTransformCache;
+
+			// triangles are processed in batches small enough for their vertex outputs to still be in cache when they are set up
+			static constexpr int32 TriangleBatchSize = 512;
+
+			void BeginVertexCache(const Model& model, FrameArena& arena);
+
+			// One byte per canvas pixel, set when the draw first writes the pixel, for counting DrawStats::PixelsCovered.
+			// Bytes rather than bits so pixels in neighbouring screen tiles can be written from different threads.
+			// Allocated from the draw's arena, and null for lone triangles, which can't cover a pixel twice
+			uint8* CoverageMap = nullptr;
+			int32 CoverageMapWidth = 0;
+
+			void BeginCoverageMap(const RenderContext& context, FrameArena& arena)
+			{
+				const Vec2i size = context.Canvas->GetSize();
+				CoverageMap = arena.Allocate<uint8>(size.X * size.Y);
+				CoverageMapWidth = size.X;
+				std::fill(CoverageMap, CoverageMap + (size_t)size.X * size.Y, (uint8)0);
+			}
+
+			// used by draws whose context has no arena
+			FrameArena OwnArena;
+
+			// the context's arena, or the rasterizer's own freshly reset
+			FrameArena& GetDrawArena(const RenderContext& context)
+			{
+				if (context.Arena != nullptr)
+				{
+					return *context.Arena;
+				}
+				OwnArena.Reset();
+				return OwnArena;
+			}
+
+			// shades the vertices of triangles [firstTri, lastTri) which haven't been shaded yet this draw
+			void ShadeBatchVertices(const Model& model, const RenderContext& context, int32 firstTri, int32 lastTri);
+
+			// Shaders may provide VertexShaderBatch(rasterizer, streams, firstVertex, count, outputs) to shade a run of consecutive
+			// vertices from the model's vertex streams at once, which is used for runs of at least MinVertexRun when the model has streams
+			static constexpr bool bHasVertexShaderBatch = requires(const TShader& shader, const IRasterizer& rasterizer, const VertexStreams& streams, VertexOutput* outputs)
+			{
+				shader.VertexShaderBatch(rasterizer, streams, 0, 0, outputs);
+			};
+			static constexpr int32 MinVertexRun = 8;
+
+			// shades the given vertices into the post-transform cache
+			void ShadeVertices(const Model& model, const int32* vertexIndices, int32 count);
+
+			// runs vertex shading, clipping and setup for each triangle of the model in order, calling onSetup(triIndex, setup) for each triangle to rasterize
+			template<class TFunction>
+			void ProcessTriangles(const Model& model, const RenderContext& context, FrameArena& arena, TFunction&& onSetup);
+
+			template<PipelineState State, bool bVisibilityBuffer>
+			void DrawTrianglesBinned(const Model& model, const RenderContext& context, FrameArena& arena);
+
+			// shades every pixel recorded in the visibility buffer
+			template<PipelineState State>
+			void ResolveVisibility(const Model& model, const RenderContext& context, const VertexOutput* vertexData);
 		};
 	}
 }
 
 template<class TShader>
-void TV::Renderer::TRasterizer<TShader>::DrawModel(const Model& model, const RenderContext& context)
+const TV::Renderer::DrawStats& TV::Renderer::TRasterizer<TShader>::DrawModel(const Model& model, const RenderContext& context)
 {
+	Stats = DrawStats();
 	if (!context.IsValid())
 	{
-		return;
+		return Stats;
 	}
 	context.Validate();
 
-	std::vector<VertexOutput> vertexData;
-	vertexData.reserve(model.NumVertices());
+#if TV_DRAW_PROFILING
+	const int64 startTime = GetDrawProfileTime();
+#endif
+	UpdateDerivedMatrices();
+
+	PipelineState state = Pipeline;
+	if (context.DepthBuffer == nullptr)
+	{
+		state.bDepthTest = false;
+		state.bDepthWrite = false;
+	}
+
+	if (context.VisibilityBuffer != nullptr)
+	{
+		// the visibility buffer relies on the depth buffer holding the nearest fragment
+		check(state.bDepthTest && state.bDepthWrite);
+		DispatchPipelineState(state, [&]<PipelineState State>()
+			{
+				if constexpr (State.bDepthTest && State.bDepthWrite)
+				{
+					DrawModelSpecialised<State, true>(model, context);
+				}
+			});
+	}
+	else
+	{
+		DispatchPipelineState(state, [&]<PipelineState State>()
+			{
+				DrawModelSpecialised<State, false>(model, context);
+			});
+	}
+
+#if TV_DRAW_PROFILING
+	Stats.DrawTime = GetDrawProfileTime() - startTime;
+#endif
+	return Stats;
+}
+
+template<class TShader>
+template<TV::Renderer::PipelineState State, bool bVisibilityBuffer>
+void TV::Renderer::TRasterizer<TShader>::DrawModelSpecialised(const Model& model, const RenderContext& context)
+{
+	if constexpr (bVisibilityBuffer)
+	{
+		context.VisibilityBuffer->ClearBuffer();
+	}
+
+	FrameArena& arena = GetDrawArena(context);
+	const size_t startScratchBytes = arena.GetBytesUsed();
+	BeginVertexCache(model, arena);
+	BeginCoverageMap(context, arena);
+
+	if (context.ThreadPool != nullptr)
+	{
+		DrawTrianglesBinned<State, bVisibilityBuffer>(model, context, arena);
+	}
+	else
+	{
+		ProcessTriangles(model, context, arena, [&](int32 triIndex, TriangleSetup& setup)
+			{
+				setup.TriangleIndex = triIndex;
+				RasterizeTriangle<State, bVisibilityBuffer>(context, setup, setup.Min, setup.Max);
+			});
+	}
+
+	if constexpr (bVisibilityBuffer)
+	{
+		ResolveVisibility<State>(model, context, PostTransformCache.Outputs);
+	}
+	CoverageMap = nullptr;
+	Stats.ScratchBytes = (int64)(arena.GetBytesUsed() - startScratchBytes);
+}
 
-	for (int32 vertexIndex = 0; vertexIndex != model.NumVertices(); ++vertexIndex)
+template<class TShader>
+const TV::Renderer::DrawStats& TV::Renderer::TRasterizer<TShader>::DrawModelWireframe(const Model& model, const RenderContext& context, const Colour& colour)
+{
+	Stats = DrawStats();
+	if (!context.IsValid())
 	{
-		vertexData.push_back(TShader::VertexShader(*this, model.GetVertex(vertexIndex)));
+		return Stats;
 	}
+	context.Validate();
+
+#if TV_DRAW_PROFILING
+	const int64 startTime = GetDrawProfileTime();
+#endif
+	UpdateDerivedMatrices();
+	Stats.TrianglesSubmitted = model.NumTris();
+
+	FrameArena& arena = GetDrawArena(context);
+	const size_t startScratchBytes = arena.GetBytesUsed();
+	BeginVertexCache(model, arena);
+	const VertexOutput* const vertexData = PostTransformCache.Outputs;
+
+	const Vec2f canvasHalfSize = ToFloat(context.Canvas->GetSize()) * 0.5f;
+	const float guardBand = ComputeGuardBand(context.Canvas->GetSize(), TriangleEdges::MaxCoordinate);
 
 	for (int triIndex = 0; triIndex != model.NumTris(); ++triIndex)
 	{
+		if (triIndex % TriangleBatchSize == 0)
+		{
+			ShadeBatchVertices(model, context, triIndex, GetMin(triIndex + TriangleBatchSize, model.NumTris()));
+		}
+
 		const Model::Tri& tri = model.GetTri(triIndex);
 
-		// todo: here we need to do clipping
+		constexpr int32 lineVertices[3][2] = { { 0, 1 }, { 0, 2 }, { 1, 2 } };
+		for (const auto& line : lineVertices)
+		{
+			Vec4f start = vertexData[tri.VertexIndex[line[0]]].Position;
+			Vec4f end = vertexData[tri.VertexIndex[line[1]]].Position;
+			if (!ClipLine(start, end, guardBand))
+			{
+				continue;
+			}
 
-		DrawTriangle(context, vertexData[tri.VertexIndex[0]], vertexData[tri.VertexIndex[1]], vertexData[tri.VertexIndex[2]]);
+			const Vec2i screenStart = GetRoundToInt(canvasHalfSize + canvasHalfSize * start.GetProjected().GetXY());
+			const Vec2i screenEnd = GetRoundToInt(canvasHalfSize + canvasHalfSize * end.GetProjected().GetXY());
+			TV::Renderer::DrawLine(screenStart, screenEnd, *context.Canvas, colour);
+		}
 	}
+	Stats.ScratchBytes = (int64)(arena.GetBytesUsed() - startScratchBytes);
+
+#if TV_DRAW_PROFILING
+	Stats.DrawTime = GetDrawProfileTime() - startTime;
+#endif
+	return Stats;
 }
 
 template<class TShader>
-void TV::Renderer::TRasterizer<TShader>::DrawModelWireframe(const Model& model, const RenderContext& context, const Colour& colour)
+void TV::Renderer::TRasterizer<TShader>::BeginVertexCache(const Model& model, FrameArena& arena)
 {
-	if (!context.IsValid())
+	VertexCache& cache = PostTransformCache;
+	if (++cache.CurrentStamp == 0)
 	{
+		// wrapped around, so old stamps could match again
+		std::fill(cache.Stamps.begin(), cache.Stamps.end(), 0);
+		cache.CurrentStamp = 1;
+	}
+
+	// new entries get a stamp older than the current one
+	cache.Outputs = arena.Allocate<VertexOutput>(model.NumVertices());
+	cache.Stamps.resize(model.NumVertices(), 0);
+}
+
+template<class TShader>
+void TV::Renderer::TRasterizer<TShader>::ShadeBatchVertices(const Model& model, const RenderContext& context, int32 firstTri, int32 lastTri)
+{
+	VertexCache& cache = PostTransformCache;
+
+	cache.Pending.clear();
+	for (int32 triIndex = firstTri; triIndex != lastTri; ++triIndex)
+	{
+		for (const int32 vertexIndex : model.GetTri(triIndex).VertexIndex)
+		{
+			if (cache.Stamps[vertexIndex] != cache.CurrentStamp)
+			{
+				cache.Stamps[vertexIndex] = cache.CurrentStamp;
+				cache.Pending.push_back(vertexIndex);
+			}
+		}
+	}
+
+	const int32 numPending = (int32)cache.Pending.size();
+	Stats.VerticesShaded += numPending;
+
+	constexpr int32 verticesPerTask = 128;
+	if (context.ThreadPool == nullptr || numPending < verticesPerTask * 2)
+	{
+		DrawStageTimer timer(Stats, DrawStage::VertexShading);
+		ShadeVertices(model, cache.Pending.data(), numPending);
 		return;
 	}
-	context.Validate();
 
-	std::vector<TShader::VertexOutput> vertexData;
-	vertexData.reserve(model.NumVertices());
+	const int32 numTasks = (numPending + verticesPerTask - 1) / verticesPerTask;
+	context.ThreadPool->ParallelFor(numTasks, [&](int32 taskIndex, int32 threadIndex)
+		{
+			const int32 first = taskIndex * verticesPerTask;
+			const int32 last = GetMin(first + verticesPerTask, numPending);
+#if TV_DRAW_PROFILING
+			DrawStats taskStats;
+			{
+				DrawStageTimer timer(taskStats, DrawStage::VertexShading);
+				ShadeVertices(model, cache.Pending.data() + first, last - first);
+			}
+			Stats.Accumulate(taskStats);
+#else
+			ShadeVertices(model, cache.Pending.data() + first, last - first);
+#endif
+		});
+}
+
+template<class TShader>
+void TV::Renderer::TRasterizer<TShader>::ShadeVertices(const Model& model, const int32* vertexIndices, int32 count)
+{
+	VertexOutput* const outputs = PostTransformCache.Outputs;
+
+	if constexpr (bHasVertexShaderBatch)
+	{
+		const VertexStreams* const streams = model.GetVertexStreams();
+		if (streams != nullptr)
+		{
+			// vertices are pending in the order triangles first use them, so a model optimized for vertex fetch gives long runs
+			int32 runStart = 0;
+			while (runStart != count)
+			{
+				int32 runEnd = runStart + 1;
+				while (runEnd != count && vertexIndices[runEnd] == vertexIndices[runEnd - 1] + 1)
+				{
+					++runEnd;
+				}
+
+				if (runEnd - runStart >= MinVertexRun)
+				{
+					TShader::VertexShaderBatch(*this, *streams, vertexIndices[runStart], runEnd - runStart, &outputs[vertexIndices[runStart]]);
+				}
+				else
+				{
+					for (int32 index = runStart; index != runEnd; ++index)
+					{
+						outputs[vertexIndices[index]] = TShader::VertexShader(*this, model.GetVertex(vertexIndices[index]));
+					}
+				}
+				runStart = runEnd;
+			}
+			return;
+		}
+	}
 
-	for (int32 vertexIndex = 0; vertexIndex != model.NumVertices(); ++vertexIndex)
+	for (int32 index = 0; index != count; ++index)
 	{
-		vertexData.push_back(TShader::VertexShader(*this, model.GetVertex(vertexIndex)));
+		outputs[vertexIndices[index]] = TShader::VertexShader(*this, model.GetVertex(vertexIndices[index]));
 	}
+}
 
-	for (int triIndex = 0; triIndex != model.NumTris(); ++triIndex)
+template<class TShader>
+template<class TFunction>
+void TV::Renderer::TRasterizer<TShader>::ProcessTriangles(const Model& model, const RenderContext& context, FrameArena& arena, TFunction&& onSetup)
+{
+	const VertexOutput* const vertexData = PostTransformCache.Outputs;
+
+	for (int32 firstTri = 0; firstTri < model.NumTris(); firstTri += TriangleBatchSize)
 	{
-		const Model::Tri& tri = model.GetTri(triIndex);
+		const int32 lastTri = GetMin(firstTri + TriangleBatchSize, model.NumTris());
+		ShadeBatchVertices(model, context, firstTri, lastTri);
+		Stats.TrianglesSubmitted += lastTri - firstTri;
 
-		// todo: here we need to do clipping
+		// onSetup may rasterize, which is timed separately
+		DrawStageTimer timer(Stats, DrawStage::Setup);
+		for (int32 triIndex = firstTri; triIndex != lastTri; ++triIndex)
+		{
+			const Model::Tri& tri = model.GetTri(triIndex);
+			ClipAndSetupTriangle(context, vertexData[tri.VertexIndex[0]], vertexData[tri.VertexIndex[1]], vertexData[tri.VertexIndex[2]], arena, Stats, [&](TriangleSetup& setup)
+				{
+					timer.Pause();
+					onSetup(triIndex, setup);
+					timer.Resume();
+				});
+		}
+	}
+}
+
+template<class TShader>
+template<TV::Renderer::PipelineState State, bool bVisibilityBuffer>
+void TV::Renderer::TRasterizer<TShader>::DrawTrianglesBinned(const Model& model, const RenderContext& context, FrameArena& arena)
+{
+	check(context.ThreadPool != nullptr);
+	check(TileSize > 0);
+
+	// threads mustn't share depth buffer coarse tiles, as they track their contents lazily
+	int32 tileSize = TileSize;
+	if constexpr (State.bDepthTest || State.bDepthWrite)
+	{
+		tileSize = ((tileSize + DepthBuffer::CoarseTileSize - 1) / DepthBuffer::CoarseTileSize) * DepthBuffer::CoarseTileSize;
+	}
+
+	const Vec2i canvasSize = context.Canvas->GetSize();
+	const Vec2i numTiles((canvasSize.X + tileSize - 1) / tileSize, (canvasSize.Y + tileSize - 1) / tileSize);
 
-		Vec3f normalisedDeviceCoordPositions[3];
-		Vec2i screenPositions[3];
+	TArenaArray<TriangleSetup> setups(arena, model.NumTris());
+	ProcessTriangles(model, context, arena, [&](int32 triIndex, TriangleSetup& setup)
+		{
+			setup.TriangleIndex = triIndex;
+			setups.Add(setup);
+		});
+
+	const auto forEachTile = [&](const TriangleSetup& setup, auto&& function)
+	{
+		for (int32 tileY = setup.Min.Y / tileSize; tileY <= setup.Max.Y / tileSize; ++tileY)
 		{
-			const Vec2f canvasHalfSize = ToFloat(context.Canvas->GetSize()) * 0.5f;
-			for (int32 index = 0; index != 3; ++index)
+			for (int32 tileX = setup.Min.X / tileSize; tileX <= setup.Max.X / tileSize; ++tileX)
 			{
-				normalisedDeviceCoordPositions[index] = vertexData[tri.VertexIndex[index]].Position.GetProjected();
-				screenPositions[index] = GetRoundToInt(canvasHalfSize + canvasHalfSize * normalisedDeviceCoordPositions[index].GetXY());
+				function(tileX + tileY * numTiles.X);
 			}
 		}
+	};
 
-		TV::Renderer::DrawLine(screenPositions[0], screenPositions[1], *context.Canvas, colour);
-		TV::Renderer::DrawLine(screenPositions[0], screenPositions[2], *context.Canvas, colour);
-		TV::Renderer::DrawLine(screenPositions[1], screenPositions[2], *context.Canvas, colour);
+	// bin triangles in submission order, so each tile sees its triangles in the same order as the serial path.
+	// Every pixel belongs to exactly one tile, which makes the output identical and means no locking is required.
+	// The bins are packed into one array by counting each tile's triangles first, tile i's being [binStarts[i], binStarts[i + 1])
+	const int32 numBins = numTiles.X * numTiles.Y;
+	int32* const binStarts = arena.Allocate<int32>(numBins + 1);
+	std::fill(binStarts, binStarts + numBins + 1, 0);
+	for (const TriangleSetup& setup : setups)
+	{
+		forEachTile(setup, [&](int32 tileIndex) { ++binStarts[tileIndex + 1]; });
+	}
+	for (int32 tileIndex = 0; tileIndex != numBins; ++tileIndex)
+	{
+		binStarts[tileIndex + 1] += binStarts[tileIndex];
+	}
+
+	int32* const binEnds = arena.Allocate<int32>(numBins);
+	std::copy(binStarts, binStarts + numBins, binEnds);
+	int32* const binSetups = arena.Allocate<int32>(binStarts[numBins]);
+	for (int32 setupIndex = 0; setupIndex != setups.GetNum(); ++setupIndex)
+	{
+		forEachTile(setups[setupIndex], [&](int32 tileIndex) { binSetups[binEnds[tileIndex]++] = setupIndex; });
 	}
+
+	context.ThreadPool->ParallelFor(numBins, [&](int32 tileIndex, int32 threadIndex)
+		{
+			const Vec2i tileMin((tileIndex % numTiles.X) * tileSize, (tileIndex / numTiles.X) * tileSize);
+			const Vec2i tileMax(GetMin(tileMin.X + tileSize, canvasSize.X) - 1, GetMin(tileMin.Y + tileSize, canvasSize.Y) - 1);
+			for (int32 binIndex = binStarts[tileIndex]; binIndex != binStarts[tileIndex + 1]; ++binIndex)
+			{
+				RasterizeTriangle<State, bVisibilityBuffer>(context, setups[binSetups[binIndex]], tileMin, tileMax);
+			}
+		});
 }
 
 template<class TShader>
@@ -127,32 +637,322 @@ void TV::Renderer::TRasterizer<TShader>::DrawTriangle(const RenderContext& conte
 {
 	check(context.IsValid());
 
-	Vec3f normalisedDeviceCoordPositions[3];
-	Vec2f screenPositions[3];
+	// a lone triangle has no index to record, so is always shaded immediately
+	PipelineState state = Pipeline;
+	if (context.DepthBuffer == nullptr)
+	{
+		state.bDepthTest = false;
+		state.bDepthWrite = false;
+	}
+
+	++Stats.TrianglesSubmitted;
+	FrameArena& arena = GetDrawArena(context);
+	DispatchPipelineState(state, [&]<PipelineState State>()
+		{
+			ClipAndSetupTriangle(context, vertexA, vertexB, vertexC, arena, Stats, [&](TriangleSetup& setup)
+				{
+					RasterizeTriangle<State, false>(context, setup, setup.Min, setup.Max);
+				});
+		});
+}
+
+template<class TShader>
+template<TV::Renderer::PipelineState State>
+void TV::Renderer::TRasterizer<TShader>::ResolveVisibility(const Model& model, const RenderContext& context, const VertexOutput* vertexData)
+{
+	const VisibilityBuffer& visibilityBuffer = *context.VisibilityBuffer;
+	const Vec2i canvasSize = context.Canvas->GetSize();
+
+	const Vec2f canvasHalfSize = ToFloat(canvasSize) * 0.5f;
+
+	const auto resolveRow = [&](int32 y, int32 threadIndex)
+	{
+		DrawStats rowStats;
+		DrawStageTimer timer(rowStats, DrawStage::FragmentShading);
+		int32 derivativesTriIndex = VisibilityBuffer::NoTriangle;
+		FragmentDerivatives derivatives;
+		Vec3f vertexW;
+		Vec3f invWBarycentricDX;
+		Vec3f invWBarycentricDY;
+		for (int32 x = 0; x != canvasSize.X; ++x)
+		{
+			const Vec2i point2D(x, y);
+			const int32 triIndex = visibilityBuffer.GetTriangleIndex(point2D);
+			if (triIndex == VisibilityBuffer::NoTriangle)
+			{
+				continue;
+			}
+
+			const Model::Tri& tri = model.GetTri(triIndex);
+			const VertexOutput& vertexA = vertexData[tri.VertexIndex[0]];
+			const VertexOutput& vertexB = vertexData[tri.VertexIndex[1]];
+			const VertexOutput& vertexC = vertexData[tri.VertexIndex[2]];
+
+			// the visibility buffer holds perspective correct barycentrics
+			const Vec3f& barycentric = visibilityBuffer.GetBarycentric(point2D);
+
+			// neighbouring pixels usually share a triangle, so the screen space gradients are only worked out when it changes
+			if constexpr (bFragmentShaderTakesDerivatives)
+			{
+				if (triIndex != derivativesTriIndex)
+				{
+					derivativesTriIndex = triIndex;
+					derivatives.Vertices[0] = &vertexA;
+					derivatives.Vertices[1] = &vertexB;
+					derivatives.Vertices[2] = &vertexC;
+
+					// a triangle crossing the camera plane can't be projected, in which case the shader sees no change
+					bool bValid = vertexA.Position.W > 0.f && vertexB.Position.W > 0.f && vertexC.Position.W > 0.f;
+					if (bValid)
+					{
+						Vec2f screenPositions[3];
+						for (int32 index = 0; index != 3; ++index)
+						{
+							screenPositions[index] = canvasHalfSize + canvasHalfSize * derivatives.Vertices[index]->Position.GetProjected().GetXY();
+							vertexW.Raw[index] = derivatives.Vertices[index]->Position.W;
+						}
+						bValid = ComputeBarycentricDerivatives(screenPositions[0], screenPositions[1], screenPositions[2], invWBarycentricDX, invWBarycentricDY);
+					}
+					if (bValid)
+					{
+						invWBarycentricDX *= vertexW.GetReciprocal();
+						invWBarycentricDY *= vertexW.GetReciprocal();
+					}
+					else
+					{
+						vertexW = Vec3f();
+						invWBarycentricDX = Vec3f();
+						invWBarycentricDY = Vec3f();
+					}
+				}
+				ComputePerspectiveBarycentricDerivatives(barycentric, vertexW, invWBarycentricDX, invWBarycentricDY, derivatives.BarycentricDX, derivatives.BarycentricDY);
+			}
+
+			const VertexOutput input = TShader::Interpolate(barycentric, vertexA, vertexB, vertexC);
+			const Colour output = RunFragmentShader(input, derivatives);
+			++rowStats.FragmentsShaded;
+			if constexpr (State.bAlphaDiscard)
+			{
+				if (output.A == 0)
+				{
+					continue;
+				}
+			}
+			WriteFragment<State.Blend>(*context.Canvas, point2D, output);
+			++rowStats.PixelsWritten;
+		}
+		timer.Pause();
+		Stats.Accumulate(rowStats);
+	};
+
+	if (context.ThreadPool != nullptr)
+	{
+		context.ThreadPool->ParallelFor(canvasSize.Y, resolveRow);
+	}
+	else
+	{
+		for (int32 y = 0; y != canvasSize.Y; ++y)
+		{
+			resolveRow(y, 0);
+		}
+	}
+}
+
+template<class TShader>
+bool TV::Renderer::TRasterizer<TShader>::SetupTriangle(const RenderContext& context, const VertexOutput& vertexA, const VertexOutput& vertexB, const VertexOutput& vertexC, TriangleSetup& setup, DrawStats& stats) const
+{
+	setup.Vertices[0] = &vertexA;
+	setup.Vertices[1] = &vertexB;
+	setup.Vertices[2] = &vertexC;
+
+	Vec2f* const screenPositions = setup.ScreenPositions;
 	{
 		const Vec2f canvasHalfSize = ToFloat(context.Canvas->GetSize()) * 0.5f;
-		const VertexOutput vertices[3] = { vertexA, vertexB, vertexC };
 		for (int32 index = 0; index != 3; ++index)
 		{
-			normalisedDeviceCoordPositions[index] = vertices[index].Position.GetProjected();
-			screenPositions[index] = canvasHalfSize + canvasHalfSize * normalisedDeviceCoordPositions[index].GetXY();
+			setup.NormalisedDeviceCoordPositions[index] = setup.Vertices[index]->Position.GetProjected();
+			screenPositions[index] = canvasHalfSize + canvasHalfSize * setup.NormalisedDeviceCoordPositions[index].GetXY();
+		}
+	}
+
+	// signed area is positive for counter clockwise triangles, the mapping to screen space doesn't flip either axis
+	const float doubleArea = GetCrossProduct(screenPositions[1] - screenPositions[0], screenPositions[2] - screenPositions[0]);
+	if (!(doubleArea != 0.f))
+	{
+		++stats.TrianglesDegenerate;
+		return false;
+	}
+	if (Pipeline.Culling != CullMode::None)
+	{
+		const bool bFrontFacing = (doubleArea > 0.f) == (FrontFaceWinding == Winding::CounterClockwise);
+		if (bFrontFacing == (Pipeline.Culling == CullMode::Front))
+		{
+			++stats.TrianglesCulled;
+			return false;
 		}
 	}
 
-	// get 2D bounding box of points
+	// triangles too big for the fixed point maths fall back to the barycentric path
+	setup.bUseEdges = Method == RasterizationMethod::EdgeFunction && TriangleEdges::IsInRange(screenPositions);
+
+	// get 2D bounding box of points, using the positions the edge equations will see
+	Vec2f boundsPositions[3];
+	for (int32 index = 0; index != 3; ++index)
+	{
+		boundsPositions[index] = setup.bUseEdges ? TriangleEdges::GetSnapped(screenPositions[index]) : screenPositions[index];
+	}
 	Vec2f min, max;
-	min.X = GetMin(screenPositions[0].X, screenPositions[1].X, screenPositions[2].X);
-	min.Y = GetMin(screenPositions[0].Y, screenPositions[1].Y, screenPositions[2].Y);
-	max.X = GetMax(screenPositions[0].X, screenPositions[1].X, screenPositions[2].X);
-	max.Y = GetMax(screenPositions[0].Y, screenPositions[1].Y, screenPositions[2].Y);
+	min.X = GetMin(boundsPositions[0].X, boundsPositions[1].X, boundsPositions[2].X);
+	min.Y = GetMin(boundsPositions[0].Y, boundsPositions[1].Y, boundsPositions[2].Y);
+	max.X = GetMax(boundsPositions[0].X, boundsPositions[1].X, boundsPositions[2].X);
+	max.Y = GetMax(boundsPositions[0].Y, boundsPositions[1].Y, boundsPositions[2].Y);
 
 	// clamp to bounds of canvas
 	min = min.GetClamped(Vec2f(), ToFloat(context.Canvas->GetSize()));
 	max = max.GetClamped(Vec2f(), ToFloat(context.Canvas->GetSize()));
 
-	const Vec2i minInt(GetFloorToInt(min.X), GetFloorToInt(min.Y));
-	const Vec2i maxInt(GetMin(GetCeilToInt(max.X), context.Canvas->GetSize().X - 1), GetMin(GetCeilToInt(max.Y), context.Canvas->GetSize().Y - 1));
+	// pixels are sampled at whole coordinates, so only those inside the bounds can be covered
+	setup.Min = Vec2i(GetCeilToInt(min.X), GetCeilToInt(min.Y));
+	setup.Max = Vec2i(GetMin(GetFloorToInt(max.X), context.Canvas->GetSize().X - 1), GetMin(GetFloorToInt(max.Y), context.Canvas->GetSize().Y - 1));
+
+	if (setup.Min.X > setup.Max.X || setup.Min.Y > setup.Max.Y)
+	{
+		// off screen, or small enough to fall between pixel centres
+		++stats.TrianglesDegenerate;
+		return false;
+	}
+
+	// depth is interpolated linearly in screen space so is bounded by the vertex values, with a little slack for rounding
+	constexpr float depthSlack = 1e-5f;
+	const float minDepth = GetMin(setup.NormalisedDeviceCoordPositions[0].Z, setup.NormalisedDeviceCoordPositions[1].Z, setup.NormalisedDeviceCoordPositions[2].Z);
+	const float maxDepth = GetMax(setup.NormalisedDeviceCoordPositions[0].Z, setup.NormalisedDeviceCoordPositions[1].Z, setup.NormalisedDeviceCoordPositions[2].Z);
+	setup.MaxDepthBufferValue = 1.f - ((minDepth * 0.5f) + 0.5f) + depthSlack;
+	setup.MinDepthBufferValue = 1.f - ((maxDepth * 0.5f) + 0.5f) - depthSlack;
+
+	if (setup.bUseEdges && !setup.Edges.Setup(screenPositions))
+	{
+		// zero area once snapped to the sub pixel grid
+		++stats.TrianglesDegenerate;
+		return false;
+	}
+
+	// clipping leaves every vertex in front of the camera, so w is positive
+	for (int32 index = 0; index != 3; ++index)
+	{
+		setup.VertexW.Raw[index] = setup.Vertices[index]->Position.W;
+	}
+	setup.VertexInvW = setup.VertexW.GetReciprocal();
+	ComputeBarycentricDerivatives(screenPositions[0], screenPositions[1], screenPositions[2], setup.InvWBarycentricDX, setup.InvWBarycentricDY);
+	setup.InvWBarycentricDX *= setup.VertexInvW;
+	setup.InvWBarycentricDY *= setup.VertexInvW;
+
+	if constexpr (bHasVaryings)
+	{
+		setup.Planes.Setup(setup.Vertices, screenPositions[0], setup.VertexInvW, setup.InvWBarycentricDX, setup.InvWBarycentricDY);
+	}
+
+	return true;
+}
+
+template<class TShader>
+template<class TFunction>
+void TV::Renderer::TRasterizer<TShader>::ClipAndSetupTriangle(const RenderContext& context, const VertexOutput& vertexA, const VertexOutput& vertexB, const VertexOutput& vertexC, FrameArena& arena, DrawStats& stats, TFunction&& onSetup) const
+{
+	const Vec4f positions[3] = { vertexA.Position, vertexB.Position, vertexC.Position };
+	const float guardBand = ComputeGuardBand(context.Canvas->GetSize(), TriangleEdges::MaxCoordinate);
+
+	ClipVertex clipVertices[MaxClippedVertices];
+	int32 numClipVertices = 0;
+	const ClipResult result = ClipTriangle(positions, guardBand, clipVertices, numClipVertices);
+
+	if (result == ClipResult::Accepted)
+	{
+		TriangleSetup setup;
+		if (SetupTriangle(context, vertexA, vertexB, vertexC, setup, stats))
+		{
+			onSetup(setup);
+		}
+		return;
+	}
+	if (result == ClipResult::Rejected)
+	{
+		++stats.TrianglesCulled;
+		return;
+	}
+	++stats.TrianglesClipped;
+
+	VertexOutput* const clippedVertices = arena.Allocate<VertexOutput>(numClipVertices);
+	for (int32 index = 0; index != numClipVertices; ++index)
+	{
+		clippedVertices[index] = TShader::Interpolate(clipVertices[index].Weights, vertexA, vertexB, vertexC);
+		clippedVertices[index].Position = clipVertices[index].Position;
+	}
+
+	// the clipped polygon is convex, so can be drawn as a fan
+	for (int32 index = 2; index < numClipVertices; ++index)
+	{
+		const int32 fanIndices[3] = { 0, index - 1, index };
+
+		TriangleSetup setup;
+		if (!SetupTriangle(context, clippedVertices[fanIndices[0]], clippedVertices[fanIndices[1]], clippedVertices[fanIndices[2]], setup, stats))
+		{
+			continue;
+		}
+		setup.bClipped = true;
+		for (int32 vertexIndex = 0; vertexIndex != 3; ++vertexIndex)
+		{
+			setup.SourceWeights[vertexIndex] = clipVertices[fanIndices[vertexIndex]].Weights;
+		}
+		onSetup(setup);
+	}
+}
+
+template<class TShader>
+template<TV::Renderer::PipelineState State, bool bVisibilityBuffer>
+void TV::Renderer::TRasterizer<TShader>::RasterizeTriangle(const RenderContext& context, const TriangleSetup& setup, const Vec2i& clipMin, const Vec2i& clipMax)
+{
+	const Vec2i minInt(GetMax(setup.Min.X, clipMin.X), GetMax(setup.Min.Y, clipMin.Y));
+	const Vec2i maxInt(GetMin(setup.Max.X, clipMax.X), GetMin(setup.Max.Y, clipMax.Y));
+	if (minInt.X > maxInt.X || minInt.Y > maxInt.Y)
+	{
+		return;
+	}
+
+	DrawStats triangleStats;
+	if (State.bDepthTest && bHierarchicalDepthTest)
+	{
+		bool bOccluded;
+		{
+			DrawStageTimer timer(triangleStats, DrawStage::DepthTest);
+			bOccluded = context.DepthBuffer->IsOccluded(minInt, maxInt, setup.MaxDepthBufferValue);
+		}
+		if (bOccluded)
+		{
+#if TV_DRAW_PROFILING
+			Stats.Accumulate(triangleStats);
+#endif
+			return;
+		}
+	}
+
+	if (setup.bUseEdges)
+	{
+		RasterizeTriangle_EdgeFunction<State, bVisibilityBuffer>(context, setup, minInt, maxInt, triangleStats);
+	}
+	else
+	{
+		RasterizeTriangle_Barycentric<State, bVisibilityBuffer>(context, setup, minInt, maxInt, triangleStats);
+	}
+	Stats.Accumulate(triangleStats);
+}
+
+template<class TShader>
+template<TV::Renderer::PipelineState State, bool bVisibilityBuffer>
+void TV::Renderer::TRasterizer<TShader>::RasterizeTriangle_Barycentric(const RenderContext& context, const TriangleSetup& setup, const Vec2i& minInt, const Vec2i& maxInt, DrawStats& stats)
+{
+	const Vec2f* const screenPositions = setup.ScreenPositions;
 
+	DrawStageTimer timer(stats, DrawStage::Rasterization);
 	for (int32 x = minInt.X; x <= maxInt.X; ++x)
 	{
 		for (int32 y = minInt.Y; y <= maxInt.Y; ++y)
@@ -165,35 +965,215 @@ void TV::Renderer::TRasterizer<TShader>::DrawTriangle(const RenderContext& conte
 				continue;
 			}
 
-			// result should be in range [-1,1] where -1 = near clip, 1 = far clip
-			float depthBufferVal = 0.f;
-			if (context.DepthBuffer != nullptr)
+			ShadePixel<State, bVisibilityBuffer>(context, setup, point2D, barycentric, stats, timer);
+			timer.Switch(DrawStage::Rasterization);
+		}
+	}
+}
+
+template<class TShader>
+template<TV::Renderer::PipelineState State, bool bVisibilityBuffer>
+void TV::Renderer::TRasterizer<TShader>::RasterizeTriangle_EdgeFunction(const RenderContext& context, const TriangleSetup& setup, const Vec2i& minInt, const Vec2i& maxInt, DrawStats& stats)
+{
+	const TriangleEdges& edges = setup.Edges;
+	const RasterSpanFunction spanFunction = GetRasterSpanFunction(MaxSimdLevel);
+
+	RasterSpanInput spanInput;
+	spanInput.Edges = &edges;
+	for (int32 index = 0; index != 3; ++index)
+	{
+		spanInput.VertexDepths[index] = setup.NormalisedDeviceCoordPositions[index].Z;
+	}
+	RasterSpanOutput spanOutput;
+
+	const bool bHierarchicalDepth = State.bDepthTest && bHierarchicalDepthTest;
+	constexpr int32 depthTileSize = DepthBuffer::TileSize;
+
+	DrawStageTimer timer(stats, DrawStage::Rasterization);
+
+	// walk bands of rows one depth buffer tile high, and within those spans of pixels, so occluded tiles can be skipped
+	// and tiles the triangle is entirely in front of drawn without a per pixel depth test.
+	// Rows are walked in order so writes are sequential in memory
+	int32 bandMaxY = 0;
+	for (int32 bandMinY = minInt.Y; bandMinY <= maxInt.Y; bandMinY = bandMaxY + 1)
+	{
+		const int32 tileY = bandMinY / depthTileSize;
+		bandMaxY = GetMin((tileY + 1) * depthTileSize - 1, maxInt.Y);
+
+		for (int32 spanX = minInt.X; spanX <= maxInt.X; spanX += RasterSpanInput::MaxPixels)
+		{
+			spanInput.NumPixels = GetMin(RasterSpanInput::MaxPixels, maxInt.X - spanX + 1);
+
+			uint64 visibleMask = spanInput.NumPixels == 64 ? ~0ull : (1ull << spanInput.NumPixels) - 1;
+			uint64 acceptedMask = 0; // pixels in tiles where every stored value is behind the triangle, so the depth test can't fail
+			if (bHierarchicalDepth)
 			{
-				const float depth = ComputeValueFromBarycentric(barycentric, normalisedDeviceCoordPositions[0].Z, normalisedDeviceCoordPositions[1].Z, normalisedDeviceCoordPositions[2].Z);
-				if (depth > 1.f || depth < -1.f)
+				timer.Switch(DrawStage::DepthTest);
+				const int32 spanEndX = spanX + spanInput.NumPixels;
+				for (int32 tileX = spanX / depthTileSize; tileX <= (spanEndX - 1) / depthTileSize; ++tileX)
 				{
-					continue;
+					const int32 first = GetMax(tileX * depthTileSize, spanX) - spanX;
+					const int32 last = GetMin((tileX + 1) * depthTileSize, spanEndX) - spanX;
+					const uint64 tileMask = ((1ull << (last - first)) - 1) << first;
+					if (context.DepthBuffer->GetTileMin(tileX, tileY) > setup.MaxDepthBufferValue)
+					{
+						visibleMask &= ~tileMask;
+					}
+					else if (!(context.DepthBuffer->GetTileMax(tileX, tileY) > setup.MinDepthBufferValue))
+					{
+						acceptedMask |= tileMask;
+					}
 				}
-				// remap value for depth buffer such that 0 = far clip, 1 = near clip
-				depthBufferVal = 1.f - ((depth * 0.5f) + 0.5f);
-				if (context.DepthBuffer->Get(point2D) > depthBufferVal)
+				timer.Switch(DrawStage::Rasterization);
+				if (visibleMask == 0)
 				{
 					continue;
 				}
 			}
 
-			const VertexOutput input = TShader::Interpolate(barycentric, vertexA, vertexB, vertexC);
-			const Colour output = TShader::FragmentShader(*this, input);
-			if (output.A > 0)
+			// the span function only tests depth if some visible pixel needs it. The tiles the triangle is rasterized in don't change
+			// while it is, other than where it writes itself, so this holds for every row of the band
+			const bool bTestSpanDepth = State.bDepthTest && (visibleMask & ~acceptedMask) != 0;
+
+			for (int32 y = bandMinY; y <= bandMaxY; ++y)
 			{
-				context.Canvas->SetPixel(point2D, output);
+				for (int32 edgeIndex = 0; edgeIndex != 3; ++edgeIndex)
+				{
+					spanInput.EdgeValues[edgeIndex] = edges.Evaluate(edgeIndex, Vec2i(spanX, y));
+				}
+				if constexpr (State.bDepthTest)
+				{
+					spanInput.DepthRow = bTestSpanDepth ? context.DepthBuffer->GetSpan(Vec2i(spanX, y), spanInput.NumPixels) : nullptr;
+				}
+
+				uint64 mask = spanFunction(spanInput, spanOutput) & visibleMask;
+				if constexpr (State.bDepthTest)
+				{
+					const uint64 coveredMask = spanOutput.CoverageMask & visibleMask;
+					stats.PixelsTested += std::popcount(coveredMask & ~acceptedMask);
+					stats.PixelsDepthAccepted += std::popcount(coveredMask & acceptedMask);
+					stats.PixelsDepthRejected += std::popcount(coveredMask & ~mask);
+				}
+				if (mask == 0)
+				{
+					continue;
+				}
 
-				if (context.DepthBuffer != nullptr)
+				timer.Switch(DrawStage::FragmentShading);
+				while (mask != 0)
 				{
-					context.DepthBuffer->Set(point2D, depthBufferVal);
+					const int32 index = std::countr_zero(mask);
+					mask &= mask - 1;
+
+					const Vec3f barycentric(spanOutput.Barycentric[0][index], spanOutput.Barycentric[1][index], spanOutput.Barycentric[2][index]);
+					ShadeFragment<State, bVisibilityBuffer>(context, setup, Vec2i(spanX + index, y), barycentric, spanOutput.DepthBufferValue[index], stats);
 				}
+				timer.Switch(DrawStage::Rasterization);
 			}
 		}
 	}
 }
 
+template<class TShader>
+template<TV::Renderer::PipelineState State, bool bVisibilityBuffer>
+void TV::Renderer::TRasterizer<TShader>::ShadePixel(const RenderContext& context, const TriangleSetup& setup, const Vec2i& point2D, const Vec3f& barycentric, DrawStats& stats, DrawStageTimer& timer)
+{
+	const Vec3f* const normalisedDeviceCoordPositions = setup.NormalisedDeviceCoordPositions;
+
+	// result is in range [-1,1] where -1 = near clip, 1 = far clip, as triangles have been clipped
+	float depthBufferVal = 0.f;
+	if constexpr (State.bDepthTest || State.bDepthWrite)
+	{
+		const float depth = ComputeValueFromBarycentric(barycentric, normalisedDeviceCoordPositions[0].Z, normalisedDeviceCoordPositions[1].Z, normalisedDeviceCoordPositions[2].Z);
+		// remap value for depth buffer such that 0 = far clip, 1 = near clip
+		depthBufferVal = 1.f - ((depth * 0.5f) + 0.5f);
+	}
+	if constexpr (State.bDepthTest)
+	{
+		timer.Switch(DrawStage::DepthTest);
+		++stats.PixelsTested;
+		if (context.DepthBuffer->Get(point2D) > depthBufferVal)
+		{
+			++stats.PixelsDepthRejected;
+			return;
+		}
+	}
+
+	timer.Switch(DrawStage::FragmentShading);
+	ShadeFragment<State, bVisibilityBuffer>(context, setup, point2D, barycentric, depthBufferVal, stats);
+}
+
+template<class TShader>
+template<TV::Renderer::PipelineState State, bool bVisibilityBuffer>
+void TV::Renderer::TRasterizer<TShader>::ShadeFragment(const RenderContext& context, const TriangleSetup& setup, const Vec2i& point2D, const Vec3f& barycentric, float depthBufferVal, DrawStats& stats)
+{
+	const auto markCovered = [&]()
+	{
+		if (CoverageMap == nullptr)
+		{
+			++stats.PixelsCovered;
+			return;
+		}
+		uint8& covered = CoverageMap[point2D.X + (size_t)point2D.Y * CoverageMapWidth];
+		stats.PixelsCovered += covered ^ 1;
+		covered = 1;
+	};
+
+	if constexpr (bVisibilityBuffer)
+	{
+		// the resolve interpolates the model triangle, so map back onto it. Clipping weights are in clip space, where perspective correct barycentrics are linear
+		const Vec3f perspectiveBarycentric = ComputePerspectiveBarycentric(barycentric, setup.VertexInvW);
+		const Vec3f sourceBarycentric = setup.bClipped ? setup.SourceWeights[0] * perspectiveBarycentric.X + setup.SourceWeights[1] * perspectiveBarycentric.Y + setup.SourceWeights[2] * perspectiveBarycentric.Z : perspectiveBarycentric;
+		context.VisibilityBuffer->Set(point2D, setup.TriangleIndex, sourceBarycentric);
+		context.DepthBuffer->Set(point2D, depthBufferVal);
+		markCovered();
+		return;
+	}
+
+	const VertexOutput& vertexA = *setup.Vertices[0];
+	const VertexOutput& vertexB = *setup.Vertices[1];
+	const VertexOutput& vertexC = *setup.Vertices[2];
+
+	Vec3f perspectiveBarycentric;
+	if constexpr (!bHasVaryings || bFragmentShaderTakesDerivatives)
+	{
+		perspectiveBarycentric = ComputePerspectiveBarycentric(barycentric, setup.VertexInvW);
+	}
+
+	VertexOutput input;
+	if constexpr (bHasVaryings)
+	{
+		setup.Planes.Evaluate(ToFloat(point2D), input);
+	}
+	else
+	{
+		input = TShader::Interpolate(perspectiveBarycentric, vertexA, vertexB, vertexC);
+	}
+
+	FragmentDerivatives derivatives;
+	if constexpr (bFragmentShaderTakesDerivatives)
+	{
+		derivatives.Vertices[0] = &vertexA;
+		derivatives.Vertices[1] = &vertexB;
+		derivatives.Vertices[2] = &vertexC;
+		ComputePerspectiveBarycentricDerivatives(perspectiveBarycentric, setup.VertexW, setup.InvWBarycentricDX, setup.InvWBarycentricDY, derivatives.BarycentricDX, derivatives.BarycentricDY);
+	}
+	const Colour output = RunFragmentShader(input, derivatives);
+	++stats.FragmentsShaded;
+	if constexpr (State.bAlphaDiscard)
+	{
+		if (output.A == 0)
+		{
+			return;
+		}
+	}
+
+	WriteFragment<State.Blend>(*context.Canvas, point2D, output);
+	++stats.PixelsWritten;
+	markCovered();
+
+	if constexpr (State.bDepthWrite)
+	{
+		context.DepthBuffer->Set(point2D, depthBufferVal);
+	}
+}
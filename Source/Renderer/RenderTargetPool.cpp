@@ -0,0 +1,49 @@
+#include "RenderTargetPool.h"
+
+std::unique_ptr<TV::Renderer::RenderTarget> TV::Renderer::RenderTargetPool::Acquire(const Vec2i& size)
+{
+	{
+		std::lock_guard<std::mutex> lock(Mutex);
+		for (size_t index = FreeTargets.size(); index-- != 0;)
+		{
+			if (FreeTargets[index]->GetSize() == size)
+			{
+				std::unique_ptr<RenderTarget> target = std::move(FreeTargets[index]);
+				FreeTargets.erase(FreeTargets.begin() + index);
+				return target;
+			}
+		}
+		++NumAllocated;
+	}
+	// allocated outside the lock, the buffers are large
+	return std::make_unique<RenderTarget>(size);
+}
+
+void TV::Renderer::RenderTargetPool::Release(std::unique_ptr<RenderTarget> target)
+{
+	check(target != nullptr);
+	std::lock_guard<std::mutex> lock(Mutex);
+	FreeTargets.push_back(std::move(target));
+}
+
+void TV::Renderer::RenderTargetPool::Trim()
+{
+	std::vector<std::unique_ptr<RenderTarget>> freed;
+	{
+		std::lock_guard<std::mutex> lock(Mutex);
+		NumAllocated -= (int32)FreeTargets.size();
+		freed.swap(FreeTargets);
+	}
+}
+
+TV::int32 TV::Renderer::RenderTargetPool::GetNumAllocated() const
+{
+	std::lock_guard<std::mutex> lock(Mutex);
+	return NumAllocated;
+}
+
+TV::int32 TV::Renderer::RenderTargetPool::GetNumFree() const
+{
+	std::lock_guard<std::mutex> lock(Mutex);
+	return (int32)FreeTargets.size();
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "../Maths/Types.h"
+#include "../Maths/Vec2.h"
+#include "../Maths/Colour.h"
+#include "DepthBuffer.h"
+#include "MemoryCanvas.h"
+#include "Rasterizer.h"
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace TV
+{
+	namespace Renderer
+	{
+		using namespace Maths;
+
+		// colour and depth buffers for drawing one view into
+		class RenderTarget
+		{
+		public:
+			explicit RenderTarget(const Vec2i& size) : Canvas(size), Depth(size) {}
+
+			const Vec2i& GetSize() const { return Depth.GetSize(); }
+
+			void Clear(const Colour& colour)
+			{
+				Canvas.Fill(colour);
+				Depth.ClearBuffer();
+			}
+
+			RenderContext GetRenderContext(Renderer::ThreadPool* threadPool = nullptr)
+			{
+				RenderContext context;
+				context.Canvas = &Canvas;
+				context.DepthBuffer = &Depth;
+				context.ThreadPool = threadPool;
+				return context;
+			}
+
+			MemoryCanvas Canvas;
+			DepthBuffer Depth;
+		};
+
+		// Keeps render targets once they're finished with, so drawing many views doesn't allocate and free buffers for every one.
+		// Thread safe, so views drawn in parallel can share one pool
+		class RenderTargetPool
+		{
+		public:
+			// returns a free target of the given size if there is one, otherwise a new one. Its contents are undefined until cleared
+			std::unique_ptr<RenderTarget> Acquire(const Vec2i& size);
+			void Release(std::unique_ptr<RenderTarget> target);
+
+			// frees the targets which aren't in use
+			void Trim();
+
+			int32 GetNumAllocated() const;
+			int32 GetNumFree() const;
+
+		private:
+			mutable std::mutex Mutex;
+			std::vector<std::unique_ptr<RenderTarget>> FreeTargets;
+			int32 NumAllocated = 0;
+		};
+	}
+}
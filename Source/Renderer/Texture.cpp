@@ -0,0 +1,191 @@
+#include "Texture.h"
+#include "ICanvas.h"
+
+#include <cmath>
+
+namespace
+{
+	using namespace TV;
+	using namespace TV::Maths;
+
+	// blends two packed colours a channel at a time, with weight in [0, 256] giving the amount of b.
+	// Alternate channels are spread over 16 bits so two can be blended with each multiply
+	uint32 BlendPacked(uint32 a, uint32 b, uint32 weight)
+	{
+		const uint32 inverseWeight = 256 - weight;
+		const uint32 blueRed = ((((a & 0x00FF00FF) * inverseWeight) + ((b & 0x00FF00FF) * weight)) >> 8) & 0x00FF00FF;
+		const uint32 greenAlpha = ((((a >> 8) & 0x00FF00FF) * inverseWeight) + (((b >> 8) & 0x00FF00FF) * weight)) & 0xFF00FF00;
+		return blueRed | greenAlpha;
+	}
+
+	// fraction is in [0, 1]
+	uint32 GetWeight(float fraction)
+	{
+		return (uint32)(fraction * 256.f + 0.5f);
+	}
+
+	// tex coords outside [0, 1] give negative texel coordinates, which need flooring rather than truncating
+	int32 GetTexelFloor(float texelCoord)
+	{
+		const int32 truncated = (int32)texelCoord;
+		return texelCoord < (float)truncated ? truncated - 1 : truncated;
+	}
+}
+
+bool TV::Renderer::Texture::Build(const ICanvas& source, bool bGenerateMips)
+{
+	Levels.clear();
+	Texels.clear();
+
+	Vec2i size = source.GetSize();
+	if (size.X <= 0 || size.Y <= 0)
+	{
+		return false;
+	}
+
+	size_t numTexels = 0;
+	while (true)
+	{
+		Level level;
+		level.Size = size;
+		level.SizeFloat = ToFloat(size);
+		level.TilesX = (size.X + TileSize - 1) / TileSize;
+		level.Offset = numTexels;
+		Levels.push_back(level);
+
+		const int32 tilesY = (size.Y + TileSize - 1) / TileSize;
+		numTexels += (size_t)level.TilesX * tilesY * TileSize * TileSize;
+
+		if (!bGenerateMips || (size.X == 1 && size.Y == 1))
+		{
+			break;
+		}
+		size = Vec2i(GetMax(size.X / 2, 1), GetMax(size.Y / 2, 1));
+	}
+	Texels.resize(numTexels);
+
+	const Level& topLevel = Levels[0];
+	for (int32 y = 0; y != topLevel.Size.Y; ++y)
+	{
+		for (int32 x = 0; x != topLevel.Size.X; ++x)
+		{
+			Texels[GetTexelIndex(topLevel, x, y)] = source.GetPixel(Vec2i(x, y)).PackedData;
+		}
+	}
+
+	for (int32 levelIndex = 1; levelIndex < NumLevels(); ++levelIndex)
+	{
+		const Level& parent = Levels[levelIndex - 1];
+		const Level& level = Levels[levelIndex];
+		for (int32 y = 0; y != level.Size.Y; ++y)
+		{
+			// odd sizes leave the last row or column out, and a side of 1 is reused
+			const int32 parentY0 = GetMin(y * 2, parent.Size.Y - 1);
+			const int32 parentY1 = GetMin(y * 2 + 1, parent.Size.Y - 1);
+			for (int32 x = 0; x != level.Size.X; ++x)
+			{
+				const int32 parentX0 = GetMin(x * 2, parent.Size.X - 1);
+				const int32 parentX1 = GetMin(x * 2 + 1, parent.Size.X - 1);
+				const Colour texels[4] =
+				{
+					Colour(Texels[GetTexelIndex(parent, parentX0, parentY0)]),
+					Colour(Texels[GetTexelIndex(parent, parentX1, parentY0)]),
+					Colour(Texels[GetTexelIndex(parent, parentX0, parentY1)]),
+					Colour(Texels[GetTexelIndex(parent, parentX1, parentY1)]),
+				};
+
+				// rounding alternately down and up from halfway, so lower levels don't drift brighter
+				const int32 rounding = 1 + ((x ^ y) & 1);
+				Colour average;
+				for (int32 channel = 0; channel != 4; ++channel)
+				{
+					average.Raw[channel] = (uint8)((texels[0].Raw[channel] + texels[1].Raw[channel] + texels[2].Raw[channel] + texels[3].Raw[channel] + rounding) / 4);
+				}
+				Texels[GetTexelIndex(level, x, y)] = average.PackedData;
+			}
+		}
+	}
+
+	return true;
+}
+
+float TV::Renderer::Texture::ComputeLevelOfDetail(const Vec2f& texCoordDX, const Vec2f& texCoordDY) const
+{
+	// the longer of the pixel's sides, measured in texels of the top level
+	const Vec2f& size = Levels[0].SizeFloat;
+	const Vec2f texelDX = texCoordDX * size;
+	const Vec2f texelDY = texCoordDY * size;
+	const float maxLengthSquared = (float)GetMax(GetDotProduct(texelDX, texelDX), GetDotProduct(texelDY, texelDY));
+	if (!(maxLengthSquared > 1.f))
+	{
+		return 0.f;
+	}
+	return GetMin(0.5f * std::log2(maxLengthSquared), (float)(NumLevels() - 1));
+}
+
+TV::Maths::Colour TV::Renderer::Texture::Sample(const Vec2f& texCoord, const Vec2f& texCoordDX, const Vec2f& texCoordDY, TextureFilter filter) const
+{
+	const float levelOfDetail = ComputeLevelOfDetail(texCoordDX, texCoordDY);
+	switch (filter)
+	{
+	case TextureFilter::Point:
+		return SamplePoint(texCoord, (int32)(levelOfDetail + 0.5f));
+	case TextureFilter::Bilinear:
+		return SampleBilinear(texCoord, (int32)(levelOfDetail + 0.5f));
+	default:
+		return SampleTrilinear(texCoord, levelOfDetail);
+	}
+}
+
+TV::Maths::Colour TV::Renderer::Texture::SamplePoint(const Vec2f& texCoord, int32 level) const
+{
+	const Level& mip = Levels[level];
+	const Vec2f texelCoord = texCoord * mip.SizeFloat;
+	return Colour(Fetch(mip, GetTexelFloor(texelCoord.X), GetTexelFloor(texelCoord.Y)));
+}
+
+TV::Maths::Colour TV::Renderer::Texture::SampleBilinear(const Vec2f& texCoord, int32 level) const
+{
+	return Colour(SampleBilinearPacked(Levels[level], texCoord));
+}
+
+TV::Maths::Colour TV::Renderer::Texture::SampleTrilinear(const Vec2f& texCoord, float levelOfDetail) const
+{
+	const int32 level = (int32)levelOfDetail;
+	const uint32 weight = GetWeight(levelOfDetail - level);
+	const uint32 sample = SampleBilinearPacked(Levels[level], texCoord);
+	if (weight == 0 || level + 1 >= NumLevels())
+	{
+		return Colour(sample);
+	}
+	return Colour(BlendPacked(sample, SampleBilinearPacked(Levels[level + 1], texCoord), weight));
+}
+
+uint32 TV::Renderer::Texture::SampleBilinearPacked(const Level& level, const Vec2f& texCoord) const
+{
+	// relative to the centre of the texel above and to the left
+	const Vec2f texelCoord = texCoord * level.SizeFloat - Vec2f(0.5f, 0.5f);
+	const int32 x = GetTexelFloor(texelCoord.X);
+	const int32 y = GetTexelFloor(texelCoord.Y);
+	const uint32 weightX = GetWeight(texelCoord.X - x);
+	const uint32 weightY = GetWeight(texelCoord.Y - y);
+
+	// the whole footprint is usually inside the level, only samples at the edges need addressing
+	int32 x0 = x, x1 = x + 1, y0 = y, y1 = y + 1;
+	if ((uint32)x >= (uint32)(level.Size.X - 1) || (uint32)y >= (uint32)(level.Size.Y - 1))
+	{
+		x0 = GetAddress(x0, level.Size.X);
+		x1 = GetAddress(x1, level.Size.X);
+		y0 = GetAddress(y0, level.Size.Y);
+		y1 = GetAddress(y1, level.Size.Y);
+	}
+
+	const size_t column0 = GetColumnPart(x0);
+	const size_t column1 = GetColumnPart(x1);
+	const uint32* const row0 = Texels.data() + level.Offset + GetRowPart(level, y0);
+	const uint32* const row1 = Texels.data() + level.Offset + GetRowPart(level, y1);
+
+	const uint32 top = BlendPacked(row0[column0], row0[column1], weightX);
+	const uint32 bottom = BlendPacked(row1[column0], row1[column1], weightX);
+	return BlendPacked(top, bottom, weightY);
+}
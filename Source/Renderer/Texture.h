@@ -0,0 +1,112 @@
+#pragma once
+
+#include "../Maths/Types.h"
+#include "../Maths/Vec2.h"
+#include "../Maths/Colour.h"
+
+#include <vector>
+
+namespace TV
+{
+	namespace Renderer
+	{
+		using namespace Maths;
+
+		class ICanvas;
+
+		enum class TextureFilter
+		{
+			Point, // nearest texel of the nearest mip level
+			Bilinear, // blend of the four nearest texels of the nearest mip level
+			Trilinear, // bilinear samples of the two nearest mip levels blended together
+		};
+
+		enum class TextureAddress
+		{
+			Wrap,
+			Clamp,
+		};
+
+		// Read only RGBA8 image with a full mip chain, for sampling in shaders.
+		// Texels are stored in small square tiles which are laid out in Morton order internally, so the texels
+		// around a sample are close together in memory whichever direction the texture is walked across the screen
+		class Texture
+		{
+		public:
+			static constexpr int32 TileShift = 3;
+			static constexpr int32 TileSize = 1 << TileShift;
+
+			TextureAddress AddressMode = TextureAddress::Wrap;
+
+			// copies the canvas and builds its mip chain by averaging blocks of 2x2 texels
+			bool Build(const ICanvas& source, bool bGenerateMips = true);
+
+			bool IsValid() const { return !Levels.empty(); }
+			int32 NumLevels() const { return (int32)Levels.size(); }
+			Vec2i GetSize(int32 level = 0) const { return Levels[level].Size; }
+
+			// the coordinate must be inside the level
+			Colour GetTexel(const Vec2i& coord, int32 level = 0) const { return Colour(Texels[GetTexelIndex(Levels[level], coord.X, coord.Y)]); }
+
+			// Mip level to sample, from the change in tex coords for a step of one pixel in x and in y.
+			// 0 is the full size image, and the result is clamped to the levels which exist
+			float ComputeLevelOfDetail(const Vec2f& texCoordDX, const Vec2f& texCoordDY) const;
+
+			// tex coords are in [0, 1] across the texture, with texel centres at half texel offsets
+			Colour Sample(const Vec2f& texCoord, const Vec2f& texCoordDX, const Vec2f& texCoordDY, TextureFilter filter) const;
+			Colour SamplePoint(const Vec2f& texCoord, int32 level = 0) const;
+			Colour SampleBilinear(const Vec2f& texCoord, int32 level = 0) const;
+			Colour SampleTrilinear(const Vec2f& texCoord, float levelOfDetail) const;
+
+		private:
+			struct Level
+			{
+				Vec2i Size;
+				Vec2f SizeFloat;
+				int32 TilesX = 0;
+				size_t Offset = 0; // of the first texel in Texels
+			};
+
+			// Spreads the low bits of a coordinate out to every other bit, interleaving x and y gives the Morton order within a tile.
+			// Tiles are in rows, so an index is the sum of independent parts for x and y
+			static constexpr uint32 Spread[TileSize] = { 0, 1, 4, 5, 16, 17, 20, 21 };
+			static size_t GetColumnPart(int32 x)
+			{
+				return ((size_t)(x >> TileShift) << (2 * TileShift)) | Spread[x & (TileSize - 1)];
+			}
+			static size_t GetRowPart(const Level& level, int32 y)
+			{
+				return (((size_t)(y >> TileShift) * level.TilesX) << (2 * TileShift)) | (Spread[y & (TileSize - 1)] << 1);
+			}
+			static size_t GetTexelIndex(const Level& level, int32 x, int32 y)
+			{
+				return level.Offset + GetColumnPart(x) + GetRowPart(level, y);
+			}
+
+			// maps a texel coordinate which may be outside the level back inside it
+			int32 GetAddress(int32 coord, int32 size) const
+			{
+				if ((uint32)coord < (uint32)size)
+				{
+					return coord;
+				}
+				if (AddressMode == TextureAddress::Clamp)
+				{
+					return coord < 0 ? 0 : size - 1;
+				}
+				const int32 wrapped = coord % size;
+				return wrapped < 0 ? wrapped + size : wrapped;
+			}
+
+			uint32 Fetch(const Level& level, int32 x, int32 y) const
+			{
+				return Texels[GetTexelIndex(level, GetAddress(x, level.Size.X), GetAddress(y, level.Size.Y))];
+			}
+
+			uint32 SampleBilinearPacked(const Level& level, const Vec2f& texCoord) const;
+
+			std::vector<Level> Levels;
+			std::vector<uint32> Texels; // Colour::PackedData of every level, padded out to whole tiles
+		};
+	}
+}
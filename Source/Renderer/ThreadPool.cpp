@@ -0,0 +1,107 @@
+#include "ThreadPool.h"
+
+#include "../Maths/Assert.h"
+
+TV::Renderer::ThreadPool::ThreadPool(int32 numThreads)
+{
+	if (numThreads <= 0)
+	{
+		numThreads = (int32)std::thread::hardware_concurrency();
+	}
+
+	// thread 0 is always the thread calling ParallelFor
+	for (int32 threadIndex = 1; threadIndex < numThreads; ++threadIndex)
+	{
+		Workers.emplace_back(&ThreadPool::WorkerLoop, this, threadIndex);
+	}
+}
+
+TV::Renderer::ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(Mutex);
+		bShutdown = true;
+	}
+	WorkAvailable.notify_all();
+
+	for (std::thread& worker : Workers)
+	{
+		worker.join();
+	}
+}
+
+void TV::Renderer::ThreadPool::ParallelFor(int32 numTasks, const TaskRef& task)
+{
+	if (numTasks <= 0)
+	{
+		return;
+	}
+
+	if (Workers.empty() || numTasks == 1)
+	{
+		for (int32 taskIndex = 0; taskIndex != numTasks; ++taskIndex)
+		{
+			task(taskIndex, 0);
+		}
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(Mutex);
+		check(CurrentTask == nullptr); // not re-entrant
+		CurrentTask = &task;
+		NumTasks = numTasks;
+		NextTaskIndex = 0;
+		NumBusyWorkers = (int32)Workers.size();
+		++Generation;
+	}
+	WorkAvailable.notify_all();
+
+	RunTasks(0);
+
+	{
+		std::unique_lock<std::mutex> lock(Mutex);
+		WorkFinished.wait(lock, [this]() { return NumBusyWorkers == 0; });
+		CurrentTask = nullptr;
+	}
+}
+
+void TV::Renderer::ThreadPool::WorkerLoop(int32 threadIndex)
+{
+	uint32 lastGeneration = 0;
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(Mutex);
+			WorkAvailable.wait(lock, [this, lastGeneration]() { return bShutdown || Generation != lastGeneration; });
+			if (bShutdown)
+			{
+				return;
+			}
+			lastGeneration = Generation;
+		}
+
+		RunTasks(threadIndex);
+
+		{
+			std::lock_guard<std::mutex> lock(Mutex);
+			if (--NumBusyWorkers == 0)
+			{
+				WorkFinished.notify_one();
+			}
+		}
+	}
+}
+
+void TV::Renderer::ThreadPool::RunTasks(int32 threadIndex)
+{
+	while (true)
+	{
+		const int32 taskIndex = NextTaskIndex.fetch_add(1);
+		if (taskIndex >= NumTasks)
+		{
+			return;
+		}
+		(*CurrentTask)(taskIndex, threadIndex);
+	}
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "../Maths/Types.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace TV
+{
+	namespace Renderer
+	{
+		// Persistent pool of worker threads used to spread rasterizer work across cores.
+		// The calling thread always takes part in the work, so a pool of 1 thread runs everything inline.
+		class ThreadPool
+		{
+		public:
+			// numThreads includes the calling thread, 0 = one per hardware thread
+			explicit ThreadPool(int32 numThreads = 0);
+			~ThreadPool();
+
+			ThreadPool(const ThreadPool&) = delete;
+			ThreadPool& operator = (const ThreadPool&) = delete;
+
+			int32 GetNumThreads() const { return (int32)Workers.size() + 1; }
+
+			// runs task(taskIndex, threadIndex) for every index in [0, numTasks) and blocks until all have completed.
+			// threadIndex is in [0, GetNumThreads()) and is stable for the duration of a single task
+			template<class TTask>
+			void ParallelFor(int32 numTasks, const TTask& task)
+			{
+				TaskRef taskRef;
+				taskRef.Task = &task;
+				taskRef.Invoke = [](const void* function, int32 taskIndex, int32 threadIndex)
+				{
+					(*(const TTask*)function)(taskIndex, threadIndex);
+				};
+				ParallelFor(numTasks, taskRef);
+			}
+
+		private:
+			// refers to the task rather than copying it like std::function would, which can allocate
+			struct TaskRef
+			{
+				const void* Task = nullptr;
+				void (*Invoke)(const void* task, int32 taskIndex, int32 threadIndex) = nullptr;
+
+				void operator () (int32 taskIndex, int32 threadIndex) const { Invoke(Task, taskIndex, threadIndex); }
+			};
+
+			void ParallelFor(int32 numTasks, const TaskRef& task);
+			void WorkerLoop(int32 threadIndex);
+			void RunTasks(int32 threadIndex);
+
+			std::vector<std::thread> Workers;
+
+			std::mutex Mutex;
+			std::condition_variable WorkAvailable;
+			std::condition_variable WorkFinished;
+
+			const TaskRef* CurrentTask = nullptr;
+			int32 NumTasks = 0;
+			std::atomic<int32> NextTaskIndex = 0;
+			int32 NumBusyWorkers = 0;
+			uint32 Generation = 0;
+			bool bShutdown = false;
+		};
+	}
+}
@@ -0,0 +1,156 @@
+#pragma once
+
+#include "../Maths/Types.h"
+#include "../Maths/Vec2.h"
+#include "../Maths/Vec3.h"
+#include "../Maths/Vec4.h"
+
+#include <array>
+#include <type_traits>
+
+namespace TV
+{
+	namespace Renderer
+	{
+		using namespace Maths;
+
+		// the floats making up each type a vertex output member can be interpolated as
+		template<class T>
+		struct TVaryingComponents;
+
+		template<>
+		struct TVaryingComponents<float>
+		{
+			static constexpr int32 Num = 1;
+			template<class T> static auto* Get(T& value) { return &value; }
+		};
+
+		template<>
+		struct TVaryingComponents<Vec2f>
+		{
+			static constexpr int32 Num = 2;
+			template<class T> static auto* Get(T& value) { return value.Raw; }
+		};
+
+		template<>
+		struct TVaryingComponents<Vec3f>
+		{
+			static constexpr int32 Num = 3;
+			template<class T> static auto* Get(T& value) { return value.Raw; }
+		};
+
+		template<>
+		struct TVaryingComponents<Vec4f>
+		{
+			static constexpr int32 Num = 4;
+			template<class T> static auto* Get(T& value) { return value.Raw; }
+		};
+
+		template<class T>
+		struct TMemberPointerTraits;
+
+		template<class TClass, class TMember>
+		struct TMemberPointerTraits<TMember TClass::*>
+		{
+			typedef TClass Class;
+			typedef TMember Member;
+		};
+
+		// Lists the members of a shader's vertex output which are interpolated for its fragment shader, e.g.
+		//     typedef TVaryings<&VertexOutput::Normal, &VertexOutput::TexCoord> Varyings;
+		// Members can be float, Vec2f, Vec3f or Vec4f. When a shader declares Varyings the rasterizer interpolates them itself,
+		// and any other members of the fragment shader's input are left default initialised
+		template<auto... Members>
+		struct TVaryings
+		{
+			static constexpr int32 NumComponents = (TVaryingComponents<typename TMemberPointerTraits<decltype(Members)>::Member>::Num + ... + 0);
+
+			// calls function(componentIndex, component) for every float of the listed members of the vertex, in order
+			template<class TVertexOutput, class TFunction>
+			static void ForEachComponent(TVertexOutput& vertex, TFunction&& function)
+			{
+				int32 componentIndex = 0;
+				(ForEachMemberComponent(vertex.*Members, componentIndex, function), ...);
+			}
+
+		private:
+			template<class T, class TFunction>
+			static void ForEachMemberComponent(T& member, int32& componentIndex, TFunction& function)
+			{
+				typedef TVaryingComponents<std::remove_const_t<T>> Components;
+				auto* const components = Components::Get(member);
+				for (int32 index = 0; index != Components::Num; ++index)
+				{
+					function(componentIndex++, components[index]);
+				}
+			}
+		};
+
+		// Perspective correct interpolation of a triangle's varyings. An attribute divided by clip space w changes linearly across the screen,
+		// as does 1/w, so the planes of both are found once per triangle and each pixel takes a reciprocal and two multiply adds per float
+		template<class TVertexOutput, class TVaryings>
+		class TAttributePlanes
+		{
+		public:
+			// origin is the screen position of the first vertex, invW holds 1/w of each vertex's clip space position, and
+			// invWDX and invWDY the screen space barycentric derivatives multiplied by those
+			void Setup(const TVertexOutput* const vertices[3], const Vec2f& origin, const Vec3f& invW, const Vec3f& invWDX, const Vec3f& invWDY)
+			{
+				Origin = origin;
+				InvW = Plane{ invW.X, invWDX.X + invWDX.Y + invWDX.Z, invWDY.X + invWDY.Y + invWDY.Z };
+
+				for (int32 vertexIndex = 0; vertexIndex != 3; ++vertexIndex)
+				{
+					TVaryings::ForEachComponent(*vertices[vertexIndex], [&](int32 componentIndex, float value)
+						{
+							Plane& plane = Components[componentIndex];
+							if (vertexIndex == 0)
+							{
+								plane = Plane{ value * invW.X, 0.f, 0.f };
+							}
+							plane.DX += value * invWDX.Raw[vertexIndex];
+							plane.DY += value * invWDY.Raw[vertexIndex];
+						});
+				}
+			}
+
+			// writes the varyings at a screen position into output
+			void Evaluate(const Vec2f& point, TVertexOutput& output) const
+			{
+				const Vec2f offset = point - Origin;
+				const float w = 1.f / (InvW.Value + InvW.DX * offset.X + InvW.DY * offset.Y);
+				TVaryings::ForEachComponent(output, [&](int32 componentIndex, float& value)
+					{
+						const Plane& plane = Components[componentIndex];
+						value = (plane.Value + plane.DX * offset.X + plane.DY * offset.Y) * w;
+					});
+			}
+
+		private:
+			// a value divided by w, at the origin and its change for a unit step in x and in y
+			struct Plane
+			{
+				float Value;
+				float DX;
+				float DY;
+			};
+
+			Vec2f Origin;
+			Plane InvW;
+			std::array<Plane, TVaryings::NumComponents> Components;
+		};
+
+		// the attribute planes for a shader's Varyings, or nothing if it doesn't declare any
+		template<class TShader>
+		struct TShaderAttributePlanes
+		{
+			struct Type {};
+		};
+
+		template<class TShader> requires requires { typename TShader::Varyings; }
+		struct TShaderAttributePlanes<TShader>
+		{
+			typedef TAttributePlanes<typename TShader::VertexOutput, typename TShader::Varyings> Type;
+		};
+	}
+}
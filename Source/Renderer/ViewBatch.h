@@ -0,0 +1,79 @@
+#pragma once
+
+#include "../Maths/Types.h"
+#include "../Maths/Vec2.h"
+#include "../Maths/Colour.h"
+#include "../Maths/Matrix4x4.h"
+#include "../Model/Model.h"
+#include "FrameArena.h"
+#include "Rasterizer.h"
+#include "RenderTargetPool.h"
+#include "ThreadPool.h"
+
+#include <memory>
+#include <vector>
+
+namespace TV
+{
+	namespace Renderer
+	{
+		using namespace Maths;
+
+		struct ViewMatrices
+		{
+			Matrix4x4f ViewMatrix;
+			Matrix4x4f ProjectionMatrix;
+		};
+
+		// Draws a model from every view in the batch, each into a render target from the pool.
+		// Each view is drawn by a copy of the prototype rasterizer with the view's matrices set, after which
+		// setupView(rasterizer, viewIndex) can change anything else that depends on the view, e.g. a camera space light direction.
+		// onRendered(viewIndex, const RenderTarget&, const DrawStats&) is then called with the finished image, before the target goes back to the pool.
+		// With at least as many views as threads, whole views are drawn in parallel, one per thread at a time: a view is a much larger
+		// unit of work than a screen tile, and doesn't wait for its slowest tile. With fewer, views are drawn in turn with their tiles in parallel.
+		// Either way both callbacks can be called from any of the pool's threads.
+		// Each view is a frame of arena, which is reset before it is drawn; views drawn in parallel use the thread arenas.
+		// Keeping the arena and target pool from one batch to the next means drawing views needs no more memory once they've warmed up
+		template<class TRasterizerType, class TSetupView, class TOnRendered>
+		void DrawViewBatch(const TRasterizerType& prototype, const Model& model, const std::vector<ViewMatrices>& views, const Vec2i& size, const Colour& clearColour,
+			RenderTargetPool& targetPool, FrameArena& arena, Renderer::ThreadPool* threadPool, TSetupView&& setupView, TOnRendered&& onRendered)
+		{
+			const auto drawView = [&](TRasterizerType& rasterizer, int32 viewIndex, FrameArena& viewArena, Renderer::ThreadPool* tilePool)
+			{
+				std::unique_ptr<RenderTarget> target = targetPool.Acquire(size);
+				target->Clear(clearColour);
+
+				rasterizer.ViewMatrix = views[viewIndex].ViewMatrix;
+				rasterizer.ProjectionMatrix = views[viewIndex].ProjectionMatrix;
+				setupView(rasterizer, viewIndex);
+
+				viewArena.Reset();
+				RenderContext context = target->GetRenderContext(tilePool);
+				context.Arena = &viewArena;
+				const DrawStats& stats = rasterizer.DrawModel(model, context);
+
+				onRendered(viewIndex, (const RenderTarget&)*target, stats);
+				targetPool.Release(std::move(target));
+			};
+
+			const int32 numViews = (int32)views.size();
+			if (threadPool == nullptr || numViews < threadPool->GetNumThreads())
+			{
+				TRasterizerType rasterizer(prototype);
+				for (int32 viewIndex = 0; viewIndex != numViews; ++viewIndex)
+				{
+					drawView(rasterizer, viewIndex, arena, threadPool);
+				}
+				return;
+			}
+
+			// a rasterizer per thread rather than per view, so their vertex buffers are reused from view to view
+			std::vector<TRasterizerType> rasterizers(threadPool->GetNumThreads(), prototype);
+			arena.SetNumThreadArenas(threadPool->GetNumThreads());
+			threadPool->ParallelFor(numViews, [&](int32 viewIndex, int32 threadIndex)
+			{
+				drawView(rasterizers[threadIndex], viewIndex, arena.GetThreadArena(threadIndex), nullptr);
+			});
+		}
+	}
+}
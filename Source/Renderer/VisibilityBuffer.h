@@ -0,0 +1,70 @@
+#pragma once
+
+#include "../Maths/Vec2.h"
+#include "../Maths/Vec3.h"
+#include "../Maths/Assert.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace TV
+{
+	namespace Renderer
+	{
+		using namespace Maths;
+
+		// Records which triangle is visible at each pixel and where on it, so shading can be deferred
+		// until visibility is resolved and then run once per pixel
+		class VisibilityBuffer
+		{
+		public:
+			static constexpr int32 NoTriangle = -1;
+
+			VisibilityBuffer(const Vec2i& size) : Size(size), TriangleIndices(size.X * size.Y), Barycentrics(size.X * size.Y)
+			{
+				ClearBuffer();
+			}
+
+			VisibilityBuffer(const VisibilityBuffer&) = delete;
+			VisibilityBuffer& operator = (const VisibilityBuffer&) = delete;
+
+			void Set(const Vec2i& point, int32 triangleIndex, const Vec3f& barycentric)
+			{
+				ValidatePoint(point);
+				TriangleIndices[point.X + point.Y * Size.X] = triangleIndex;
+				Barycentrics[point.X + point.Y * Size.X] = barycentric;
+			}
+
+			int32 GetTriangleIndex(const Vec2i& point) const
+			{
+				ValidatePoint(point);
+				return TriangleIndices[point.X + point.Y * Size.X];
+			}
+			const Vec3f& GetBarycentric(const Vec2i& point) const
+			{
+				ValidatePoint(point);
+				return Barycentrics[point.X + point.Y * Size.X];
+			}
+
+			const Vec2i& GetSize() const { return Size; }
+
+			void ClearBuffer()
+			{
+				std::fill(TriangleIndices.begin(), TriangleIndices.end(), NoTriangle);
+			}
+
+			void ValidatePoint(const Vec2i& point) const
+			{
+				check(point.X >= 0);
+				check(point.Y >= 0);
+				check(point.X < Size.X);
+				check(point.Y < Size.Y);
+			}
+
+		private:
+			const Vec2i Size;
+			std::vector<int32> TriangleIndices;
+			std::vector<Vec3f> Barycentrics;
+		};
+	}
+}
@@ -0,0 +1,25 @@
+#include "DefaultScene.h"
+
+void TV::Shaders::DefaultScene::Setup(Rasterizer_SimpleLitDiffuse& rasterizer, float aspectRatio, const Texture* diffuse, bool bOrthographic)
+{
+	// build camera matrix
+	const Matrix4x4f cameraMtx = Matrix4x4f::MakeLookAt(CameraPosition, Vec3f(), Vec3f::UpVector);
+	rasterizer.ViewMatrix = cameraMtx.GetInverse();
+
+	// build projection matrix
+	if (bOrthographic)
+	{
+		rasterizer.ProjectionMatrix = Matrix4x4f::MakeOrthographicProjection(OrthographicWidth, aspectRatio, NearClip, FarClip);
+	}
+	else
+	{
+		rasterizer.ProjectionMatrix = Matrix4x4f::MakePerspectiveProjection(GetRadiansFromDegrees(VerticalFieldOfView), aspectRatio, NearClip, FarClip);
+	}
+
+	// the model is closed, so back faces are always hidden
+	rasterizer.Pipeline.Culling = CullMode::Back;
+
+	rasterizer.Diffuse = diffuse;
+	rasterizer.BaseColour = Colour(255, 255, 255, 255);
+	rasterizer.LightDirection = rasterizer.ViewMatrix.TransformVector(LightDirection.GetSafeNormal());
+}
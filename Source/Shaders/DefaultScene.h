@@ -0,0 +1,27 @@
+#pragma once
+
+#include "Shader_SimpleLitDiffuse.h"
+
+namespace TV
+{
+	namespace Shaders
+	{
+		using namespace Maths;
+		using namespace Renderer;
+
+		// The scene the viewer draws: a model at the origin seen from (1, 1, 3), lit from (1, 1, 1), with back faces culled.
+		// The benchmark and golden image test draw it too, so they measure and check what the viewer shows
+		struct DefaultScene
+		{
+			static constexpr Vec3f CameraPosition = Vec3f(1.f, 1.f, 3.f);
+			static constexpr float VerticalFieldOfView = 30.f; // degrees, for perspective projection
+			static constexpr float OrthographicWidth = 2.f;
+			static constexpr float NearClip = 0.1f;
+			static constexpr float FarClip = 1000.f;
+			static constexpr Vec3f LightDirection = Vec3f(1.f, 1.f, 1.f); // world space, towards the light
+
+			// sets the rasterizer's matrices, light, material and culling. Diffuse is optional
+			static void Setup(Rasterizer_SimpleLitDiffuse& rasterizer, float aspectRatio, const Texture* diffuse, bool bOrthographic = false);
+		};
+	}
+}
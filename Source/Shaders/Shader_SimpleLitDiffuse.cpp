@@ -1,22 +1,15 @@
 #include "Shader_SimpleLitDiffuse.h"
+#include "../Maths/TransformBatch.h"
 
 TV::Shaders::Shader_SimpleLitDiffuse::VertexOutput TV::Shaders::Shader_SimpleLitDiffuse::VertexShader(const IRasterizer& shader, const Vertex& input) const
 {
 	VertexOutput output;
 
 	// output position in clip space
-	{
-		const Vec3f worldSpacePosition = shader.ModelMatrix.TransformPosition(input.Position);
-		const Vec3f cameraSpacePosition = shader.ViewMatrix.TransformPosition(worldSpacePosition);
-		output.Position = shader.ProjectionMatrix.TransformVector4(Vec4f(cameraSpacePosition, 1.f));
-	}
+	output.Position = shader.ModelViewProjectionMatrix.TransformVector4(Vec4f(input.Position, 1.f));
 
 	// output normal in camera space
-	{
-		const Vec3f worldSpaceNormal = shader.ModelMatrix.TransformVector(input.Normal);
-		output.Normal = shader.ViewMatrix.TransformVector(worldSpaceNormal);
-		output.Normal = output.Normal.GetSafeNormal();
-	}
+	output.Normal = shader.ModelViewMatrix.TransformVector(input.Normal).GetSafeNormal();
 
 	// copy tex coord
 	output.TexCoord = input.TexCoord;
@@ -24,16 +17,43 @@ TV::Shaders::Shader_SimpleLitDiffuse::VertexOutput TV::Shaders::Shader_SimpleLit
 	return output;
 }
 
+void TV::Shaders::Shader_SimpleLitDiffuse::VertexShaderBatch(const IRasterizer& shader, const VertexStreams& input, int32 firstVertex, int32 count, VertexOutput* outputs) const
+{
+	// transformed in chunks small enough to stay in L1
+	constexpr int32 chunkSize = 64;
+	float positionX[chunkSize], positionY[chunkSize], positionZ[chunkSize], positionW[chunkSize];
+	float normalX[chunkSize], normalY[chunkSize], normalZ[chunkSize];
+
+	for (int32 chunkStart = 0; chunkStart < count; chunkStart += chunkSize)
+	{
+		const int32 first = firstVertex + chunkStart;
+		const int32 num = GetMin(chunkSize, count - chunkStart);
+
+		TransformPositionsSoA(shader.ModelViewProjectionMatrix, &input.PositionX[first], &input.PositionY[first], &input.PositionZ[first], num, positionX, positionY, positionZ, positionW, shader.MaxSimdLevel);
+		TransformVectorsSoA(shader.ModelViewMatrix, &input.NormalX[first], &input.NormalY[first], &input.NormalZ[first], num, normalX, normalY, normalZ, shader.MaxSimdLevel);
+		NormalizeSoA(normalX, normalY, normalZ, num, shader.MaxSimdLevel);
+
+		VertexOutput* const chunkOutputs = outputs + chunkStart;
+		for (int32 index = 0; index != num; ++index)
+		{
+			VertexOutput& output = chunkOutputs[index];
+			output.Position = Vec4f(Vec3f(positionX[index], positionY[index], positionZ[index]), positionW[index]);
+			output.Normal = Vec3f(normalX[index], normalY[index], normalZ[index]);
+			output.TexCoord = Vec2f(input.TexCoordX[first + index], input.TexCoordY[first + index]);
+		}
+	}
+}
+
 TV::Shaders::Shader_SimpleLitDiffuse::VertexOutput TV::Shaders::Shader_SimpleLitDiffuse::Interpolate(const Vec3f& barycentricCoord, const VertexOutput& a, const VertexOutput& b, const VertexOutput& c) const
 {
 	VertexOutput output;
 	output.Position = ComputeValueFromBarycentric(barycentricCoord, a.Position, b.Position, c.Position);
-	output.Normal = ComputeValueFromBarycentric(barycentricCoord, a.Normal, b.Normal, c.Normal).GetSafeNormal();
+	output.Normal = ComputeValueFromBarycentric(barycentricCoord, a.Normal, b.Normal, c.Normal);
 	output.TexCoord = ComputeValueFromBarycentric(barycentricCoord, a.TexCoord, b.TexCoord, c.TexCoord);
 	return output;
 }
 
-TV::Maths::Colour TV::Shaders::Shader_SimpleLitDiffuse::FragmentShader(const IRasterizer& shader, const VertexOutput& input) const
+TV::Maths::Colour TV::Shaders::Shader_SimpleLitDiffuse::FragmentShader(const IRasterizer& shader, const VertexOutput& input, const TFragmentDerivatives<VertexOutput>& derivatives) const
 {
 	Colour output;
 
@@ -41,12 +61,12 @@ TV::Maths::Colour TV::Shaders::Shader_SimpleLitDiffuse::FragmentShader(const IRa
 
 	if (Diffuse != nullptr)
 	{
-		const Vec2i texSample(GetRoundToInt(input.TexCoord.X * Diffuse->GetSize().X), GetRoundToInt(input.TexCoord.Y * Diffuse->GetSize().Y));
-		output = Diffuse->GetPixel(texSample);
+		output = Diffuse->Sample(input.TexCoord, derivatives.GetDDX(&VertexOutput::TexCoord), derivatives.GetDDY(&VertexOutput::TexCoord), DiffuseFilter);
 		output.A = 255; // todo: no alpha channel in sample image, need a way to handle this
 	}
 
-	const double lightIntensity = GetDotProduct(LightDirection, input.Normal);
+	// interpolated normals are shorter than unit length between the vertices
+	const double lightIntensity = GetDotProduct(LightDirection, input.Normal.GetSafeNormal());
 	output = output.Scaled(GetMax(0.0, lightIntensity));
 
 	return output;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../Renderer/Rasterizer.h"
+#include "../Renderer/Texture.h"
 
 namespace TV
 {
@@ -13,7 +14,8 @@ namespace TV
 		{
 		public:
 			Vec3f LightDirection; // camera space
-			const class ICanvas* Diffuse = nullptr;
+			const Texture* Diffuse = nullptr;
+			TextureFilter DiffuseFilter = TextureFilter::Trilinear;
 			Colour BaseColour;
 
 			struct VertexOutput
@@ -22,9 +24,12 @@ namespace TV
 				Vec3f Normal; // camera space
 				Vec2f TexCoord;
 			};
+			typedef TVaryings<&VertexOutput::Normal, &VertexOutput::TexCoord> Varyings;
+
 			VertexOutput VertexShader(const IRasterizer& shader, const Vertex& input) const;
+			void VertexShaderBatch(const IRasterizer& shader, const VertexStreams& input, int32 firstVertex, int32 count, VertexOutput* outputs) const;
 			VertexOutput Interpolate(const Vec3f& barycentricCoord, const VertexOutput& a, const VertexOutput& b, const VertexOutput& c) const;
-			Colour FragmentShader(const IRasterizer& shader, const VertexOutput& input) const;
+			Colour FragmentShader(const IRasterizer& shader, const VertexOutput& input, const TFragmentDerivatives<VertexOutput>& derivatives) const;
 		};
 
 		using Rasterizer_SimpleLitDiffuse = TRasterizer<Shader_SimpleLitDiffuse>;
@@ -0,0 +1,313 @@
+#include "ImageCompare.h"
+#include "../Image/TgaFiles.h"
+#include "../Model/Model.h"
+#include "../Renderer/RenderTargetPool.h"
+#include "../Renderer/ThreadPool.h"
+#include "../Renderer/VisibilityBuffer.h"
+#include "../Shaders/DefaultScene.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace TV;
+using namespace TV::Tests;
+
+namespace
+{
+	// RenderModel's canvas size in the viewer
+	const Vec2i ImageSize(600, 800);
+
+	// Allows for the odd pixel changing from compiler or floating point differences between machines, but not for anything visible
+	constexpr ImageTolerance GoldenTolerance = { 2, 0.0005, 0.0001 };
+
+	enum class SceneVariant
+	{
+		Default,
+		Threaded, // binned into tiles drawn by a thread pool
+		Scalar, // edge function path without simd
+		SSE2,
+		NoHierarchicalDepth,
+		Barycentric, // the reference rasterizer
+		VisibilityBuffer,
+	};
+
+	// Draws african_head in the viewer's default scene. Variants draw the same image through another path,
+	// and are compared against the base scene's golden image rather than having their own
+	struct GoldenScene
+	{
+		const char* Name;
+		const char* GoldenName;
+		bool bWireframe = false;
+		bool bOrthographic = false;
+		SceneVariant Variant = SceneVariant::Default;
+		ImageTolerance Tolerance = GoldenTolerance;
+		bool bMatchesGoldenSceneExactly = false; // must also be identical to the base scene as drawn in the same run
+	};
+
+	// the reference rasterizer differs along some triangle edges, where the two paths round coverage and interpolants differently
+	constexpr ImageTolerance BarycentricTolerance = { 2, 0.01, 0.005 };
+
+	const GoldenScene Scenes[] =
+	{
+		{ "shaded_perspective", "shaded_perspective" },
+		{ "shaded_orthographic", "shaded_orthographic", false, true },
+		{ "wireframe_perspective", "wireframe_perspective", true },
+		{ "wireframe_orthographic", "wireframe_orthographic", true, true },
+
+		{ "shaded_perspective_threaded", "shaded_perspective", false, false, SceneVariant::Threaded, GoldenTolerance, true },
+		{ "shaded_orthographic_threaded", "shaded_orthographic", false, true, SceneVariant::Threaded, GoldenTolerance, true },
+		{ "wireframe_perspective_threaded", "wireframe_perspective", true, false, SceneVariant::Threaded, GoldenTolerance, true },
+		{ "shaded_perspective_scalar", "shaded_perspective", false, false, SceneVariant::Scalar, GoldenTolerance, true },
+		{ "shaded_perspective_sse2", "shaded_perspective", false, false, SceneVariant::SSE2, GoldenTolerance, true },
+		{ "shaded_perspective_no_hierarchical_depth", "shaded_perspective", false, false, SceneVariant::NoHierarchicalDepth, GoldenTolerance, true },
+		// interpolates from the barycentrics it stored rather than freshly computed ones, so is a level out in a few pixels
+		{ "shaded_perspective_visibility_buffer", "shaded_perspective", false, false, SceneVariant::VisibilityBuffer },
+		{ "shaded_perspective_barycentric", "shaded_perspective", false, false, SceneVariant::Barycentric, BarycentricTolerance },
+		{ "shaded_orthographic_barycentric", "shaded_orthographic", false, true, SceneVariant::Barycentric, BarycentricTolerance },
+	};
+
+	struct TestOptions
+	{
+		std::string ContentDirectory = "Content";
+		std::string GoldenDirectory = "Tests/Golden";
+		std::string OutputDirectory = "golden_failures";
+		std::string Filter;
+		int32 NumThreads = 4;
+		bool bUpdate = false;
+	};
+
+	struct SceneAssets
+	{
+		Model HeadModel;
+		Texture Diffuse;
+	};
+
+	bool LoadAssets(const std::string& contentDirectory, SceneAssets& outAssets)
+	{
+		ModelLoadOptions loadOptions;
+		loadOptions.bOptimize = true;
+		loadOptions.bVertexStreams = true;
+		const std::string modelFile = contentDirectory + "/african_head.obj";
+		if (!outAssets.HeadModel.LoadWavefrontFile(modelFile.c_str(), loadOptions))
+		{
+			std::fprintf(stderr, "can't load %s\n", modelFile.c_str());
+			return false;
+		}
+
+		const std::string diffuseFile = contentDirectory + "/african_head_diffuse.tga";
+		if (!LoadTexture(diffuseFile.c_str(), outAssets.Diffuse))
+		{
+			std::fprintf(stderr, "can't load %s\n", diffuseFile.c_str());
+			return false;
+		}
+		return true;
+	}
+
+	std::unique_ptr<RenderTarget> RenderScene(const GoldenScene& scene, const SceneAssets& assets, Renderer::ThreadPool& threadPool)
+	{
+		std::unique_ptr<RenderTarget> target = std::make_unique<RenderTarget>(ImageSize);
+		target->Clear(Colour(0, 0, 0, 0));
+
+		Shaders::Rasterizer_SimpleLitDiffuse rasterizer;
+		Shaders::DefaultScene::Setup(rasterizer, ImageSize.X / (float)ImageSize.Y, &assets.Diffuse, scene.bOrthographic);
+
+		RenderContext context = target->GetRenderContext();
+		std::unique_ptr<VisibilityBuffer> visibilityBuffer;
+		switch (scene.Variant)
+		{
+		case SceneVariant::Threaded: context.ThreadPool = &threadPool; break;
+		case SceneVariant::Scalar: rasterizer.MaxSimdLevel = SimdLevel::Scalar; break;
+		case SceneVariant::SSE2: rasterizer.MaxSimdLevel = SimdLevel::SSE2; break;
+		case SceneVariant::NoHierarchicalDepth: rasterizer.bHierarchicalDepthTest = false; break;
+		case SceneVariant::Barycentric: rasterizer.Method = RasterizationMethod::Barycentric; break;
+		case SceneVariant::VisibilityBuffer:
+			visibilityBuffer = std::make_unique<VisibilityBuffer>(ImageSize);
+			context.VisibilityBuffer = visibilityBuffer.get();
+			break;
+		default: break;
+		}
+
+		if (scene.bWireframe)
+		{
+			context.DepthBuffer = nullptr;
+			rasterizer.DrawModelWireframe(assets.HeadModel, context, Colour(255, 255, 255, 255));
+		}
+		else
+		{
+			rasterizer.DrawModel(assets.HeadModel, context);
+		}
+		return target;
+	}
+
+	// keeps the images needed to see what went wrong, the heatmap being the quickest to read
+	void WriteFailureImages(const TestOptions& options, const GoldenScene& scene, const ICanvas& actual, const ICanvas& expected, const ImageComparison& comparison, const char* suffix)
+	{
+		std::error_code error;
+		std::filesystem::create_directories(options.OutputDirectory, error);
+
+		const std::string prefix = options.OutputDirectory + "/" + scene.Name + suffix;
+		WriteCanvasTga(actual, (prefix + "_actual.tga").c_str());
+		WriteCanvasTga(expected, (prefix + "_expected.tga").c_str());
+		if (comparison.bSizesMatch)
+		{
+			MemoryCanvas heatmap(comparison.Size);
+			DrawDifferenceHeatmap(comparison, expected, heatmap);
+			WriteCanvasTga(heatmap, (prefix + "_heatmap.tga").c_str());
+		}
+		std::printf("    wrote %s_*.tga\n", prefix.c_str());
+	}
+
+	bool CheckScene(const TestOptions& options, const GoldenScene& scene, const ICanvas& actual, const ICanvas& expected, const ImageTolerance& tolerance, const char* against, const char* suffix)
+	{
+		const ImageComparison comparison = CompareImages(actual, expected, tolerance);
+		const bool bPassed = comparison.Passes(tolerance);
+		std::printf("%-4s %-42s vs %-28s %s\n", bPassed ? "ok" : "FAIL", scene.Name, against, comparison.Describe().c_str());
+		if (!bPassed)
+		{
+			WriteFailureImages(options, scene, actual, expected, comparison, suffix);
+		}
+		return bPassed;
+	}
+
+	void PrintUsage(const char* programName)
+	{
+		std::printf("usage: %s [options]\n\n", programName);
+		std::printf("Renders a fixed set of scenes and compares them against golden images. Variants draw a base scene\n");
+		std::printf("through another path, threaded, with less simd or with the reference rasterizer, and are checked\n");
+		std::printf("against its golden image too. Run from the repository root.\n\n");
+		std::printf("  --update                      write the golden images of the base scenes instead of checking them\n");
+		std::printf("  --filter <text>               only scenes with this in their name\n");
+		std::printf("  --threads <n>                 threads for the threaded variants, default 4\n");
+		std::printf("  --content <dir>               directory with african_head, default Content\n");
+		std::printf("  --golden <dir>                golden images, default Tests/Golden\n");
+		std::printf("  --output <dir>                where failing scenes write actual, expected and heatmap images, default golden_failures\n");
+		std::printf("  --help                        show this message\n");
+	}
+}
+
+int main(int argc, char** argv)
+{
+	TestOptions options;
+	for (int32 index = 1; index < argc; ++index)
+	{
+		const std::string argument = argv[index];
+		if (argument == "--help" || argument == "-h")
+		{
+			PrintUsage(argv[0]);
+			return 0;
+		}
+		if (argument == "--update")
+		{
+			options.bUpdate = true;
+			continue;
+		}
+		if (index + 1 == argc)
+		{
+			std::fprintf(stderr, "missing value for %s\n", argument.c_str());
+			return 1;
+		}
+		const std::string value = argv[++index];
+		if (argument == "--filter")
+		{
+			options.Filter = value;
+		}
+		else if (argument == "--threads")
+		{
+			options.NumThreads = std::atoi(value.c_str());
+		}
+		else if (argument == "--content")
+		{
+			options.ContentDirectory = value;
+		}
+		else if (argument == "--golden")
+		{
+			options.GoldenDirectory = value;
+		}
+		else if (argument == "--output")
+		{
+			options.OutputDirectory = value;
+		}
+		else
+		{
+			std::fprintf(stderr, "unknown option %s\n\n", argument.c_str());
+			PrintUsage(argv[0]);
+			return 1;
+		}
+	}
+
+	SceneAssets assets;
+	if (!LoadAssets(options.ContentDirectory, assets))
+	{
+		return 1;
+	}
+	Renderer::ThreadPool threadPool(options.NumThreads);
+
+	// base scenes as drawn in this run, for the variants which must match them exactly
+	std::map<std::string, std::unique_ptr<RenderTarget>> baseRenders;
+
+	int32 numFailed = 0;
+	int32 numChecked = 0;
+	for (const GoldenScene& scene : Scenes)
+	{
+		const bool bBaseScene = scene.Variant == SceneVariant::Default;
+		if (!options.Filter.empty() && std::string(scene.Name).find(options.Filter) == std::string::npos)
+		{
+			continue;
+		}
+		if (options.bUpdate && !bBaseScene)
+		{
+			continue;
+		}
+
+		std::unique_ptr<RenderTarget> target = RenderScene(scene, assets, threadPool);
+		const std::string goldenFile = options.GoldenDirectory + "/" + scene.GoldenName + ".tga";
+		if (options.bUpdate)
+		{
+			if (!WriteCanvasTga(target->Canvas, goldenFile.c_str()))
+			{
+				std::fprintf(stderr, "can't write %s\n", goldenFile.c_str());
+				return 1;
+			}
+			std::printf("wrote %s\n", goldenFile.c_str());
+			continue;
+		}
+
+		++numChecked;
+		const std::unique_ptr<MemoryCanvas> golden = ReadCanvasTga(goldenFile.c_str());
+		if (golden == nullptr)
+		{
+			std::printf("FAIL %-42s can't read %s, run with --update to create it\n", scene.Name, goldenFile.c_str());
+			++numFailed;
+			continue;
+		}
+
+		bool bPassed = CheckScene(options, scene, target->Canvas, *golden, scene.Tolerance, "golden", "");
+		if (scene.bMatchesGoldenSceneExactly)
+		{
+			std::unique_ptr<RenderTarget>& base = baseRenders[scene.GoldenName];
+			if (base == nullptr)
+			{
+				GoldenScene baseScene = scene;
+				baseScene.Variant = SceneVariant::Default;
+				base = RenderScene(baseScene, assets, threadPool);
+			}
+			bPassed &= CheckScene(options, scene, target->Canvas, base->Canvas, ImageTolerance(), scene.GoldenName, "_vs_base");
+		}
+		if (bBaseScene)
+		{
+			baseRenders[scene.Name] = std::move(target);
+		}
+		numFailed += bPassed ? 0 : 1;
+	}
+
+	if (!options.bUpdate)
+	{
+		std::printf("%d of %d scenes passed\n", numChecked - numFailed, numChecked);
+	}
+	return numFailed == 0 ? 0 : 1;
+}
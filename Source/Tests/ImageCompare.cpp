@@ -0,0 +1,178 @@
+#include "ImageCompare.h"
+#include "../Maths/Assert.h"
+#include "../Maths/Maths.h"
+
+#include <array>
+#include <cmath>
+#include <cstdio>
+
+namespace
+{
+	using namespace TV;
+	using namespace TV::Maths;
+	using namespace TV::Tests;
+
+	struct LabColour
+	{
+		float L = 0.f;
+		float A = 0.f;
+		float B = 0.f;
+	};
+
+	float GetLinearFromSrgb(uint8 value)
+	{
+		static const std::array<float, 256> table = []()
+		{
+			std::array<float, 256> values;
+			for (int32 index = 0; index != 256; ++index)
+			{
+				const float srgb = index / 255.f;
+				values[index] = srgb <= 0.04045f ? srgb / 12.92f : std::pow((srgb + 0.055f) / 1.055f, 2.4f);
+			}
+			return values;
+		}();
+		return table[value];
+	}
+
+	// sRGB to CIELAB with a D65 white point
+	LabColour GetLab(const Colour& colour)
+	{
+		const float r = GetLinearFromSrgb(colour.R);
+		const float g = GetLinearFromSrgb(colour.G);
+		const float b = GetLinearFromSrgb(colour.B);
+
+		const float x = (0.4124f * r + 0.3576f * g + 0.1805f * b) / 0.95047f;
+		const float y = 0.2126f * r + 0.7152f * g + 0.0722f * b;
+		const float z = (0.0193f * r + 0.1192f * g + 0.9505f * b) / 1.08883f;
+
+		const auto f = [](float t)
+		{
+			constexpr float delta = 6.f / 29.f;
+			return t > delta * delta * delta ? std::cbrt(t) : t / (3.f * delta * delta) + 4.f / 29.f;
+		};
+		const float fx = f(x);
+		const float fy = f(y);
+		const float fz = f(z);
+
+		LabColour lab;
+		lab.L = 116.f * fy - 16.f;
+		lab.A = 500.f * (fx - fy);
+		lab.B = 200.f * (fy - fz);
+		return lab;
+	}
+
+	float GetDeltaE(const Colour& first, const Colour& second)
+	{
+		const LabColour a = GetLab(first);
+		const LabColour b = GetLab(second);
+		return std::sqrt((a.L - b.L) * (a.L - b.L) + (a.A - b.A) * (a.A - b.A) + (a.B - b.B) * (a.B - b.B));
+	}
+
+	Colour GetHeatmapColour(float deltaE)
+	{
+		constexpr float maxDeltaE = 20.f;
+		const Colour ramp[] = { Colour(0, 0, 255), Colour(0, 255, 0), Colour(255, 255, 0), Colour(255, 0, 0) };
+		constexpr int32 numSegments = (int32)(sizeof(ramp) / sizeof(ramp[0])) - 1;
+
+		const float position = GetClamped(deltaE / maxDeltaE, 0.f, 1.f) * numSegments;
+		const int32 segment = GetMin((int32)position, numSegments - 1);
+		const float alpha = position - segment;
+		Colour colour;
+		for (int32 channel = 0; channel != 3; ++channel)
+		{
+			colour.Raw[channel] = (uint8)(ramp[segment].Raw[channel] + (ramp[segment + 1].Raw[channel] - ramp[segment].Raw[channel]) * alpha + 0.5f);
+		}
+		return colour;
+	}
+}
+
+bool TV::Tests::ImageComparison::Passes(const ImageTolerance& tolerance) const
+{
+	if (!bSizesMatch)
+	{
+		return false;
+	}
+	const double numPixels = (double)Size.X * Size.Y;
+	return NumMismatched <= tolerance.MaxMismatchedFraction * numPixels && NumPerceptible <= tolerance.MaxPerceptibleFraction * numPixels;
+}
+
+std::string TV::Tests::ImageComparison::Describe() const
+{
+	if (!bSizesMatch)
+	{
+		return "sizes differ";
+	}
+	char text[256];
+	std::snprintf(text, sizeof(text), "%lld different, %lld over tolerance, %lld perceptible, max channel difference %d, delta E mean %.4f max %.2f",
+		(long long)NumDifferent, (long long)NumMismatched, (long long)NumPerceptible, MaxChannelDifference, MeanDeltaE, MaxDeltaE);
+	return text;
+}
+
+TV::Tests::ImageComparison TV::Tests::CompareImages(const ICanvas& actual, const ICanvas& expected, const ImageTolerance& tolerance)
+{
+	ImageComparison comparison;
+	comparison.Size = expected.GetSize();
+	comparison.bSizesMatch = actual.GetSize() == expected.GetSize();
+	if (!comparison.bSizesMatch)
+	{
+		return comparison;
+	}
+
+	comparison.DeltaE.resize((size_t)comparison.Size.X * comparison.Size.Y);
+	double totalDeltaE = 0.0;
+	for (int32 y = 0; y != comparison.Size.Y; ++y)
+	{
+		for (int32 x = 0; x != comparison.Size.X; ++x)
+		{
+			const Vec2i point(x, y);
+			const Colour actualColour = actual.GetPixel(point);
+			const Colour expectedColour = expected.GetPixel(point);
+
+			int32 maxChannelDifference = 0;
+			for (int32 channel = 0; channel != 3; ++channel)
+			{
+				maxChannelDifference = GetMax(maxChannelDifference, std::abs(actualColour.Raw[channel] - expectedColour.Raw[channel]));
+			}
+			if (maxChannelDifference == 0)
+			{
+				continue;
+			}
+
+			const float deltaE = GetDeltaE(actualColour, expectedColour);
+			comparison.DeltaE[x + (size_t)y * comparison.Size.X] = deltaE;
+			totalDeltaE += deltaE;
+
+			++comparison.NumDifferent;
+			comparison.NumMismatched += maxChannelDifference > tolerance.ChannelTolerance ? 1 : 0;
+			comparison.NumPerceptible += deltaE > PerceptibleDeltaE ? 1 : 0;
+			comparison.MaxChannelDifference = GetMax(comparison.MaxChannelDifference, maxChannelDifference);
+			comparison.MaxDeltaE = GetMax(comparison.MaxDeltaE, deltaE);
+		}
+	}
+	comparison.MeanDeltaE = totalDeltaE / ((double)comparison.Size.X * comparison.Size.Y);
+	return comparison;
+}
+
+void TV::Tests::DrawDifferenceHeatmap(const ImageComparison& comparison, const ICanvas& expected, ICanvas& heatmap)
+{
+	check(comparison.bSizesMatch);
+	check(heatmap.GetSize() == comparison.Size && expected.GetSize() == comparison.Size);
+
+	for (int32 y = 0; y != comparison.Size.Y; ++y)
+	{
+		for (int32 x = 0; x != comparison.Size.X; ++x)
+		{
+			const Vec2i point(x, y);
+			const float deltaE = comparison.DeltaE[x + (size_t)y * comparison.Size.X];
+			if (deltaE > 0.f)
+			{
+				heatmap.SetPixel(point, GetHeatmapColour(deltaE));
+				continue;
+			}
+
+			const Colour colour = expected.GetPixel(point);
+			const uint8 grey = (uint8)((colour.R * 54 + colour.G * 183 + colour.B * 19) / (256 * 4));
+			heatmap.SetPixel(point, Colour(grey, grey, grey));
+		}
+	}
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "../Maths/Types.h"
+#include "../Maths/Vec2.h"
+#include "../Renderer/ICanvas.h"
+
+#include <string>
+#include <vector>
+
+namespace TV
+{
+	namespace Tests
+	{
+		using namespace Maths;
+		using namespace Renderer;
+
+		// how far an image may be from its reference and still pass. The defaults only pass identical images
+		struct ImageTolerance
+		{
+			int32 ChannelTolerance = 0; // difference in any channel a pixel can have and still count as matching
+			double MaxMismatchedFraction = 0.0; // fraction of pixels allowed to differ by more than ChannelTolerance
+			double MaxPerceptibleFraction = 0.0; // fraction of pixels allowed a difference a viewer would notice, see PerceptibleDeltaE
+		};
+
+		// CIE76 colour difference generally taken as just noticeable
+		constexpr float PerceptibleDeltaE = 2.3f;
+
+		// Differences between two images' RGB channels, alpha is ignored. Colour differences are measured as CIE76 delta E,
+		// the distance between the colours in CIELAB, which is roughly perceptually uniform so a given delta E looks much the same in any colour
+		struct ImageComparison
+		{
+			bool bSizesMatch = false;
+			Vec2i Size;
+
+			int64 NumDifferent = 0; // pixels which aren't identical
+			int64 NumMismatched = 0; // pixels with a channel differing by more than the tolerance
+			int64 NumPerceptible = 0; // pixels with a delta E over PerceptibleDeltaE
+			int32 MaxChannelDifference = 0;
+			double MeanDeltaE = 0.0;
+			float MaxDeltaE = 0.f;
+
+			std::vector<float> DeltaE; // per pixel, rows in canvas order
+
+			bool Passes(const ImageTolerance& tolerance) const;
+			std::string Describe() const;
+		};
+
+		ImageComparison CompareImages(const ICanvas& actual, const ICanvas& expected, const ImageTolerance& tolerance);
+
+		// Draws the differences found by a comparison into heatmap, which must be the size of the compared images.
+		// Identical pixels are a dim grey copy of expected for context, differing ones run from blue for the slightest
+		// through green and yellow to red at a delta E of 20 and over
+		void DrawDifferenceHeatmap(const ImageComparison& comparison, const ICanvas& expected, ICanvas& heatmap);
+	}
+}
@@ -1,9 +1,12 @@
+#include "Image/TgaFiles.h"
 #include "Image/TgaImage.h"
 
 #include "Model/Model.h"
 #include "Renderer/DepthBuffer.h"
 #include "Renderer/Rasterizer.h"
-#include "Shaders/Shader_SimpleLitDiffuse.h"
+#include "Renderer/Texture.h"
+#include "Renderer/ThreadPool.h"
+#include "Shaders/DefaultScene.h"
 
 #include <windows.h>
 
@@ -32,6 +35,8 @@ public:
 		{
 			OldBitmap = SelectObject(DeviceContext, Bitmap);
 		}
+		// dib section rows are dword aligned, which 32 bit pixels always are
+		SetMemory((uint8*)Pixels, size, size.X * sizeof(uint32), PixelFormat::BGRA8);
 		Clear(Colour(0, 0, 0));
 	}
 	~WindowsCanvas()
@@ -69,13 +74,7 @@ public:
 
 	void Clear(const Colour& clearColour)
 	{
-		for (int32 x = 0; x != Size.X; ++x)
-		{
-			for (int32 y = 0; y != Size.Y; ++y)
-			{
-				SetPixel(Vec2i(x, y), clearColour);
-			}
-		}
+		Fill(clearColour);
 	}
 
 	HDC GetDeviceContext() const { return DeviceContext; }
@@ -92,7 +91,8 @@ private:
 struct Globals
 {
 	Model _Model;
-	TGAImage _ModelDiffuse;
+	Texture _ModelDiffuse;
+	ThreadPool _ThreadPool;
 
 	bool bLoaded = false;
 	bool bQuit = false;
@@ -103,13 +103,16 @@ struct RenderTargets
 {
 	DepthBuffer _DepthBuffer;
 	WindowsCanvas _FrameBuffer;
+	FrameArena _FrameArena;
 
 	RenderTargets(const Vec2i& size) : _DepthBuffer(size), _FrameBuffer(size) {}
 
+	// called at the start of every frame
 	void Clear()
 	{
 		_DepthBuffer.ClearBuffer();
 		_FrameBuffer.Clear(Colour(0, 0, 0));
+		_FrameArena.Reset();
 	}
 
 	RenderContext GetRenderContext()
@@ -117,6 +120,8 @@ struct RenderTargets
 		RenderContext context;
 		context.Canvas = &_FrameBuffer;
 		context.DepthBuffer = &_DepthBuffer;
+		context.ThreadPool = &g_globals._ThreadPool;
+		context.Arena = &_FrameArena;
 		return context;
 	}
 };
@@ -124,16 +129,19 @@ RenderTargets* g_renderTargets = nullptr;
 
 bool LoadResources()
 {
-	if (!g_globals._Model.LoadWavefrontFile("Content/african_head.obj"))
+	ModelLoadOptions loadOptions;
+	loadOptions.ThreadPool = &g_globals._ThreadPool;
+	loadOptions.bOptimize = true;
+	loadOptions.bVertexStreams = true;
+	if (!g_globals._Model.LoadWavefrontFileCached("Content/african_head.obj", "Content/african_head.tmdl", loadOptions))
 	{
 		return false;
 	}
 
-	if (!g_globals._ModelDiffuse.read_tga_file("Content/african_head_diffuse.tga"))
+	if (!LoadTexture("Content/african_head_diffuse.tga", g_globals._ModelDiffuse))
 	{
 		return false;
 	}
-	g_globals._ModelDiffuse.flip_vertically();
 
 	g_globals.bLoaded = true;
 	return true;
@@ -146,35 +154,8 @@ void RenderModel(const RenderContext& renderContext, bool bWireframe)
 		return;
 	}
 
-	const float aspectRatio = renderContext.Canvas->GetAspectRatio();
-
 	TV::Shaders::Rasterizer_SimpleLitDiffuse rasterizer;
-
-	// build camera matrix
-	const Vec3f cameraPos(1.f, 1.f, 3.f);
-	const Matrix4x4f cameraMtx = Matrix4x4f::MakeLookAt(cameraPos, Vec3f(), Vec3f::UpVector);
-	rasterizer.ViewMatrix = cameraMtx.GetInverse();
-	rasterizer.Diffuse = &g_globals._ModelDiffuse;
-
-	// build projection matrix
-	constexpr float nearclip = 0.1f;
-	constexpr float farclip = 1000.f;
-	constexpr bool bOrthographic = false;
-	if (bOrthographic)
-	{
-		constexpr float orthoWidth = 2.f;
-		rasterizer.ProjectionMatrix = Matrix4x4f::MakeOrthographicProjection(orthoWidth, aspectRatio, nearclip, farclip);
-	}
-	else
-	{
-		constexpr float verticalFieldOfView = GetRadiansFromDegrees(30.f);
-		rasterizer.ProjectionMatrix = Matrix4x4f::MakePerspectiveProjection(verticalFieldOfView, aspectRatio, nearclip, farclip);
-	}
-
-	rasterizer.BaseColour = white;
-
-	const Vec3f lightDir = Vec3f(1.f, 1.f, 1.f).GetSafeNormal();
-	rasterizer.LightDirection = rasterizer.ViewMatrix.TransformVector(lightDir);
+	TV::Shaders::DefaultScene::Setup(rasterizer, renderContext.Canvas->GetAspectRatio(), &g_globals._ModelDiffuse);
 
 	if (bWireframe)
 	{
@@ -201,18 +182,7 @@ void Render(HWND hwnd)
 	{
 		bDumpedBuffer = true;
 
-		{
-			TGAImage image(g_renderTargets->_FrameBuffer.GetSize().X, g_renderTargets->_FrameBuffer.GetSize().Y, TGAImage::RGB);
-			for (int32 x = 0; x != image.get_width(); ++x)
-			{
-				for (int32 y = 0; y != image.get_height(); ++y)
-				{
-					image.SetPixel(Vec2i(x, y), g_renderTargets->_FrameBuffer.GetPixel(Vec2i(x, y)));
-				}
-			}
-			image.flip_vertically();
-			image.write_tga_file("framebuffer.tga");
-		}
+		WriteCanvasTga(g_renderTargets->_FrameBuffer, "framebuffer.tga");
 		{
 			TGAImage image(g_renderTargets->_DepthBuffer.GetSize().X, g_renderTargets->_DepthBuffer.GetSize().Y, TGAImage::RGB);
 			for (int32 x = 0; x != image.get_width(); ++x)
@@ -322,6 +292,7 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
 		RenderContext renderContext;
 		renderContext.Canvas = &image;
 		renderContext.DepthBuffer = &depthBuffer;
+		renderContext.ThreadPool = &g_globals._ThreadPool;
 		RenderModel(renderContext, false);
 		image.flip_vertically();
 		image.write_tga_file("output.tga");